@@ -0,0 +1,47 @@
+// Utility comuni ai benchmark
+// Contiene:
+//      - Stopwatch: cronometro ad alta risoluzione basato su std::chrono::steady_clock
+//      - do_not_optimize(value): impedisce al compilatore di eliminare un risultato non usato
+//      - print_row(label, value, unit): stampa una riga di risultato allineata
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef __BENCH_UTILS_HPP__
+#define __BENCH_UTILS_HPP__
+
+#include <chrono>
+#include <cstdio>
+
+class Stopwatch
+{
+private:
+    std::chrono::steady_clock::time_point _start;                               // Istante di partenza
+
+public:
+    Stopwatch() : _start(std::chrono::steady_clock::now()) {}                   // Il cronometro parte alla costruzione
+
+    void restart() { _start = std::chrono::steady_clock::now(); }               // Riparte da zero
+
+    double elapsed_ns() const                                                   // Nanosecondi trascorsi dalla partenza
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - _start).count();
+    }
+};
+
+template <typename T>
+inline void do_not_optimize(const T& value)                                     // Barriera per l'ottimizzatore
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+inline void print_row(const char* label, double value, const char* unit)         // Riga di risultato allineata
+{
+    std::printf("  %-40s %12.3f %s\n", label, value, unit);
+}
+
+#endif // __BENCH_UTILS_HPP__
@@ -0,0 +1,212 @@
+// Microbenchmark delle primitive DaisySP usate (o usabili) nel percorso del delay
+// Misura in nanosecondi per campione mono, con ingresso e ritardi generati da seed fissi:
+//      - DelayLine: Read, Read(float), ReadHermite, Allpass e ReadBlock/WriteBlock, ognuno con la Write del campione
+//      - Svf::Process, OnePole::Process (passa-basso e passa-alto)
+//      - Chorus::Process, Flanger::Process
+//      - FIR: Process e ProcessBlock con 32 e 256 coefficienti
+// La linea di ritardo è scritta per intero prima di ogni misura, così le letture non passano
+// dal percorso dopo Reset() (campioni non ancora scritti letti come zero).
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "daisysp.h"
+#include "BenchUtils.h"
+#include <cmath>
+#include <random>
+#include <vector>
+
+#define SAMPLE_RATE 48000.f
+#define NUM_SAMPLES 4096                                                        // Campioni del segnale di ingresso, ripetuto
+#define NUM_PASSES 256                                                          // Ripetizioni del segnale per ogni misura
+#define BLOCK_SIZE 64                                                           // Campioni per chiamata delle versioni a blocchi
+#define LINE_SIZE 65536                                                         // Campioni della linea di ritardo (potenza di due)
+#define BASE_DELAY 7200.f                                                       // Ritardo di lettura in campioni (150 ms)
+#define MOD_DEPTH 240.f                                                         // Escursione del ritardo modulato in campioni
+#define FIR_SHORT 32
+#define FIR_LONG 256
+
+static std::vector<float> input(NUM_SAMPLES);                                   // Rumore bianco
+static std::vector<float> delays(NUM_SAMPLES);                                  // Ritardo modulato in campioni
+static std::vector<float> output(NUM_SAMPLES);
+
+static void generate_signals()
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    for (int i = 0; i < NUM_SAMPLES; i++)
+    {
+        input[i] = dist(rng);
+        delays[i] = BASE_DELAY + MOD_DEPTH * std::sin(2.f * static_cast<float>(M_PI) * i / NUM_SAMPLES) + 0.25f * dist(rng);
+    }
+}
+
+// Esegue process(in, delays, out, n) su tutto il segnale NUM_PASSES volte, in blocchi di block_size campioni
+template <typename Function>
+static double ns_per_sample(Function&& process, int block_size = NUM_SAMPLES)
+{
+    Stopwatch sw;
+    for (int pass = 0; pass < NUM_PASSES; pass++)
+    {
+        for (int start = 0; start < NUM_SAMPLES; start += block_size)
+            process(input.data() + start, delays.data() + start, output.data() + start, block_size);
+        do_not_optimize(output[0]);
+    }
+    return sw.elapsed_ns() / (static_cast<double>(NUM_PASSES) * NUM_SAMPLES);
+}
+
+static void fill_line(daisysp::DelayLine<float, 0>& line)                       // Linea scritta per intero (stato a regime)
+{
+    line.Reset();
+    for (int i = 0; i < LINE_SIZE; i++)
+        line.Write(input[i % NUM_SAMPLES]);
+}
+
+static void bench_delay_line()
+{
+    static std::vector<float> memory(LINE_SIZE);
+    daisysp::DelayLine<float, 0> line;
+    line.Init(memory.data(), LINE_SIZE);
+
+    fill_line(line);
+    line.SetDelay(BASE_DELAY + 0.5f);
+    print_row("DelayLine::Read + Write", ns_per_sample([&](const float* in, const float*, float* out, int n)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            out[i] = line.Read();
+            line.Write(in[i]);
+        }
+    }), "ns");
+
+    fill_line(line);
+    print_row("DelayLine::Read(float) + Write", ns_per_sample([&](const float* in, const float* d, float* out, int n)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            out[i] = line.Read(d[i]);
+            line.Write(in[i]);
+        }
+    }), "ns");
+
+    fill_line(line);
+    print_row("DelayLine::ReadHermite + Write", ns_per_sample([&](const float* in, const float* d, float* out, int n)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            out[i] = line.ReadHermite(d[i]);
+            line.Write(in[i]);
+        }
+    }), "ns");
+
+    fill_line(line);
+    print_row("DelayLine::Allpass", ns_per_sample([&](const float* in, const float*, float* out, int n)
+    {
+        for (int i = 0; i < n; i++)
+            out[i] = line.Allpass(in[i], static_cast<size_t>(BASE_DELAY), 0.5f);
+    }), "ns");
+
+    fill_line(line);
+    print_row("DelayLine::ReadBlock + WriteBlock", ns_per_sample([&](const float* in, const float* d, float* out, int n)
+    {
+        line.ReadBlock(out, d, static_cast<size_t>(n));
+        line.WriteBlock(in, static_cast<size_t>(n));
+    }, BLOCK_SIZE), "ns");
+}
+
+static void bench_filters()
+{
+    daisysp::Svf svf;
+    svf.Init(SAMPLE_RATE);
+    svf.SetFreq(2000.f);
+    svf.SetRes(0.3f);
+    print_row("Svf::Process", ns_per_sample([&](const float* in, const float*, float* out, int n)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            svf.Process(in[i]);
+            out[i] = svf.Low();
+        }
+    }), "ns");
+
+    daisysp::OnePole low_pass;
+    low_pass.Init();
+    low_pass.SetFrequency(3000.f / SAMPLE_RATE);
+    print_row("OnePole::Process (low-pass)", ns_per_sample([&](const float* in, const float*, float* out, int n)
+    {
+        for (int i = 0; i < n; i++)
+            out[i] = low_pass.Process(in[i]);
+    }), "ns");
+
+    daisysp::OnePole high_pass;
+    high_pass.Init();
+    high_pass.SetFilterMode(daisysp::OnePole::FILTER_MODE_HIGH_PASS);
+    high_pass.SetFrequency(200.f / SAMPLE_RATE);
+    print_row("OnePole::Process (high-pass)", ns_per_sample([&](const float* in, const float*, float* out, int n)
+    {
+        for (int i = 0; i < n; i++)
+            out[i] = high_pass.Process(in[i]);
+    }), "ns");
+}
+
+static void bench_effects()
+{
+    daisysp::Chorus chorus;
+    chorus.Init(SAMPLE_RATE);
+    chorus.SetLfoFreq(0.8f);
+    chorus.SetLfoDepth(0.6f);
+    chorus.SetDelayMs(8.f);
+    print_row("Chorus::Process", ns_per_sample([&](const float* in, const float*, float* out, int n)
+    {
+        for (int i = 0; i < n; i++)
+            out[i] = chorus.Process(in[i]);
+    }), "ns");
+
+    daisysp::Flanger flanger;
+    flanger.Init(SAMPLE_RATE);
+    flanger.SetLfoFreq(0.3f);
+    flanger.SetLfoDepth(0.8f);
+    flanger.SetFeedback(0.6f);
+    print_row("Flanger::Process", ns_per_sample([&](const float* in, const float*, float* out, int n)
+    {
+        for (int i = 0; i < n; i++)
+            out[i] = flanger.Process(in[i]);
+    }), "ns");
+}
+
+template <size_t num_taps>
+static void bench_fir(const char* label_process, const char* label_block)
+{
+    std::mt19937 rng(5678);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    float ir[num_taps];
+    for (size_t k = 0; k < num_taps; k++)
+        ir[k] = dist(rng) / static_cast<float>(num_taps);
+
+    static daisysp::FIR<num_taps, BLOCK_SIZE> fir;
+    fir.SetIR(ir, num_taps, false);
+    print_row(label_process, ns_per_sample([&](const float* in, const float*, float* out, int n)
+    {
+        for (int i = 0; i < n; i++)
+            out[i] = fir.Process(in[i]);
+    }), "ns");
+
+    fir.Reset();
+    print_row(label_block, ns_per_sample([&](const float* in, const float*, float* out, int n)
+    {
+        fir.ProcessBlock(in, out, static_cast<size_t>(n));
+    }, BLOCK_SIZE), "ns");
+}
+
+int main()
+{
+    generate_signals();
+
+    std::printf("DaisySP primitives, %d passes of %d samples at %.0f Hz (ns/sample)\n", NUM_PASSES, NUM_SAMPLES, SAMPLE_RATE);
+    bench_delay_line();
+    bench_filters();
+    bench_effects();
+    bench_fir<FIR_SHORT>("FIR<32>::Process", "FIR<32>::ProcessBlock");
+    bench_fir<FIR_LONG>("FIR<256>::Process", "FIR<256>::ProcessBlock");
+
+    return 0;
+}
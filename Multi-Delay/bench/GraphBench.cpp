@@ -0,0 +1,318 @@
+// Benchmark di scalabilità di più istanze di AudioPluginAudioProcessor in un juce::AudioProcessorGraph
+// Per N istanze (1, 2, 4, ... fino a --max-instances) collegate in serie (ingresso -> 1 -> 2 -> ... -> N -> uscita)
+// e in parallelo (ingresso -> ogni istanza -> uscita) elabora --seconds secondi di audio e riporta:
+//      - ns/sample/inst: tempo di CPU per campione stereo e per istanza (costante se le istanze scalano linearmente)
+//      - p99/max us: distribuzione del tempo di un processBlock del grafo
+//      - LLC miss, L1D miss: cache miss per campione e per istanza, letti dai contatori hardware di Linux
+//        (perf_event_open; "n/a" se non disponibili, es. con /proc/sys/kernel/perf_event_paranoid > 2)
+//      - memory: memoria allocata da tutte le istanze (linee di ritardo comprese), da confrontare con le dimensioni
+//        di L2/L3 stampate all'inizio
+// Opzioni:
+//      --max-instances <n>  numero massimo di istanze (default 64)
+//      --seconds <s>        secondi di audio per misura (default 2)
+//      --block-size <n>     campioni per blocco (default 256)
+//      --sample-rate <r>    sample rate (default 48000)
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "PluginProcessor.h"
+#include "BenchUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <random>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define HAS_MALLINFO2 1
+#endif
+
+#define NUM_CHANNELS 2
+#define WARMUP_BLOCKS 16                                                        // Blocchi non misurati dopo prepareToPlay
+
+enum class Topology { series, parallel };
+
+// Contatore hardware di Linux per il thread corrente; non valido se il kernel non lo concede
+class PerfCounter
+{
+private:
+    int _fd = -1;
+
+public:
+    enum Event { llc_misses, l1d_read_misses };
+
+    PerfCounter(Event event)
+    {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        if (event == llc_misses)
+        {
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;                           // Miss dell'ultimo livello di cache
+        }
+        else
+        {
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        }
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        _fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+        juce::ignoreUnused(event);
+#endif
+    }
+
+    ~PerfCounter()
+    {
+#if defined(__linux__)
+        if (_fd >= 0)
+            close(_fd);
+#endif
+    }
+
+    bool is_valid() const { return _fd >= 0; }
+
+    void start()
+    {
+#if defined(__linux__)
+        if (_fd >= 0)
+        {
+            ioctl(_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    double stop()                                                               // Eventi contati dall'ultimo start()
+    {
+#if defined(__linux__)
+        uint64_t count = 0;
+        if (_fd >= 0)
+        {
+            ioctl(_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(_fd, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count)))
+                count = 0;
+        }
+        return static_cast<double>(count);
+#else
+        return 0.;
+#endif
+    }
+};
+
+struct Result
+{
+    double cpu_ns_per_sample_instance;
+    double p99_us;
+    double max_us;
+    double llc_misses;                                                          // Per campione e per istanza
+    double l1d_misses;
+};
+
+static double cpu_time_ns()                                                     // Tempo di CPU del processo
+{
+#if defined(CLOCK_PROCESS_CPUTIME_ID)
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) * 1e9 + static_cast<double>(ts.tv_nsec);
+#else
+    return static_cast<double>(std::clock()) * 1e9 / CLOCKS_PER_SEC;
+#endif
+}
+
+static size_t heap_in_use()                                                     // Byte allocati sullo heap (0 se non misurabile)
+{
+#if defined(HAS_MALLINFO2)
+    const auto info = mallinfo2();
+    return info.uordblks + info.hblkhd;                                         // Blocchi dell'arena più blocchi grandi allocati con mmap
+#else
+    return 0;
+#endif
+}
+
+static void cache_size(const char* label, int name)
+{
+#if defined(__linux__) && defined(_SC_LEVEL2_CACHE_SIZE)
+    const long bytes = sysconf(name);
+    if (bytes > 0)
+    {
+        std::printf("  %-4s %8.1f KiB\n", label, bytes / 1024.);
+        return;
+    }
+#endif
+    juce::ignoreUnused(name);
+    std::printf("  %-4s      n/a\n", label);
+}
+
+static void set_parameter(juce::AudioProcessor& processor, const juce::String& id, float value)  // Imposta un parametro come farebbe un host
+{
+    for (auto* parameter : processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            if (ranged->paramID == id)
+                ranged->setValueNotifyingHost(ranged->convertTo0to1(value));
+}
+
+static std::unique_ptr<AudioPluginAudioProcessor> create_instance(int index)
+{
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    set_parameter(*processor, "delay-sx", 150.f + 7.f * static_cast<float>(index % 16));   // Ritardi diversi: le istanze non leggono in fase
+    set_parameter(*processor, "delay-dx", 220.f + 5.f * static_cast<float>(index % 16));
+    set_parameter(*processor, "feedback", 0.3f);                                // Guadagno limitato anche con molte istanze in serie
+    set_parameter(*processor, "amount", 0.5f);
+    return processor;
+}
+
+static Result run(int num_instances, Topology topology, double sample_rate, int block_size, double seconds, size_t& bytes_per_instance)
+{
+    using IOProcessor = juce::AudioProcessorGraph::AudioGraphIOProcessor;
+
+    juce::AudioProcessorGraph graph;
+    graph.setPlayConfigDetails(NUM_CHANNELS, NUM_CHANNELS, sample_rate, block_size);
+    auto input = graph.addNode(std::make_unique<IOProcessor>(IOProcessor::audioInputNode));
+    auto output = graph.addNode(std::make_unique<IOProcessor>(IOProcessor::audioOutputNode));
+
+    const size_t heap_before = heap_in_use();
+    auto previous = input;
+    for (int i = 0; i < num_instances; i++)
+    {
+        auto node = graph.addNode(create_instance(i));
+        auto source = (topology == Topology::series) ? previous : input;
+        for (int ch = 0; ch < NUM_CHANNELS; ch++)
+            graph.addConnection({ { source->nodeID, ch }, { node->nodeID, ch } });
+        if (topology == Topology::parallel)
+            for (int ch = 0; ch < NUM_CHANNELS; ch++)
+                graph.addConnection({ { node->nodeID, ch }, { output->nodeID, ch } });
+        previous = node;
+    }
+    if (topology == Topology::series)
+        for (int ch = 0; ch < NUM_CHANNELS; ch++)
+            graph.addConnection({ { previous->nodeID, ch }, { output->nodeID, ch } });
+
+    graph.prepareToPlay(sample_rate, block_size);                               // Prepara le istanze e costruisce la sequenza di rendering
+    const size_t heap_after = heap_in_use();
+    bytes_per_instance = heap_after > heap_before ? (heap_after - heap_before) / static_cast<size_t>(num_instances) : 0;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> noise(-0.1f, 0.1f);
+    juce::AudioBuffer<float> buffer(NUM_CHANNELS, block_size);
+    juce::MidiBuffer midi;
+    auto process_block = [&]
+    {
+        for (int ch = 0; ch < NUM_CHANNELS; ch++)
+            for (int i = 0; i < block_size; i++)
+                buffer.getWritePointer(ch)[i] = noise(rng);
+        Stopwatch sw;
+        graph.processBlock(buffer, midi);
+        const double elapsed = sw.elapsed_ns();
+        do_not_optimize(buffer.getReadPointer(0)[0]);
+        return elapsed;
+    };
+
+    for (int block = 0; block < WARMUP_BLOCKS; block++)
+        process_block();
+
+    const int num_blocks = std::max(1, static_cast<int>(seconds * sample_rate) / block_size);
+    std::vector<double> block_times(static_cast<size_t>(num_blocks));
+    PerfCounter llc_counter(PerfCounter::llc_misses);
+    PerfCounter l1d_counter(PerfCounter::l1d_read_misses);
+
+    const double cpu_start = cpu_time_ns();
+    llc_counter.start();
+    l1d_counter.start();
+    for (int block = 0; block < num_blocks; block++)
+        block_times[static_cast<size_t>(block)] = process_block();
+    const double llc_misses = llc_counter.stop();
+    const double l1d_misses = l1d_counter.stop();
+    const double cpu_ns = cpu_time_ns() - cpu_start;
+    graph.releaseResources();
+
+    std::sort(block_times.begin(), block_times.end());
+    const double samples_instances = static_cast<double>(num_blocks) * block_size * num_instances;
+
+    Result result;
+    result.cpu_ns_per_sample_instance = cpu_ns / samples_instances;
+    result.p99_us = block_times[static_cast<size_t>(0.99 * (num_blocks - 1) + 0.5)] * 1e-3;
+    result.max_us = block_times.back() * 1e-3;
+    result.llc_misses = llc_counter.is_valid() ? llc_misses / samples_instances : -1.;
+    result.l1d_misses = l1d_counter.is_valid() ? l1d_misses / samples_instances : -1.;
+    return result;
+}
+
+static void print_misses(double misses)
+{
+    if (misses < 0.)
+        std::printf(" %10s", "n/a");
+    else
+        std::printf(" %10.4f", misses);
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juce_initialiser;                           // Message manager per AudioProcessorGraph e AudioProcessorValueTreeState
+
+    int max_instances = 64;
+    double seconds = 2.;
+    int block_size = 256;
+    double sample_rate = 48000.;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--max-instances") == 0 && has_value)
+            max_instances = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--seconds") == 0 && has_value)
+            seconds = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--block-size") == 0 && has_value)
+            block_size = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--sample-rate") == 0 && has_value)
+            sample_rate = std::max(1., std::atof(argv[++i]));
+        else
+        {
+            std::printf("usage: %s [--max-instances n] [--seconds s] [--block-size n] [--sample-rate r]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::printf("AudioProcessorGraph of AudioPluginAudioProcessor, %.0f Hz, %d samples per block, %.1f s per run\n", sample_rate, block_size, seconds);
+    std::printf("Caches:\n");
+#if defined(__linux__) && defined(_SC_LEVEL2_CACHE_SIZE)
+    cache_size("L2", _SC_LEVEL2_CACHE_SIZE);
+    cache_size("L3", _SC_LEVEL3_CACHE_SIZE);
+#else
+    cache_size("L2", 0);                                                        // Dimensioni non note: stampa n/a
+    cache_size("L3", 0);
+#endif
+
+    for (Topology topology : { Topology::series, Topology::parallel })
+    {
+        std::printf("\n%s\n  %5s %12s %15s %10s %10s %10s %10s\n", topology == Topology::series ? "Series" : "Parallel",
+                    "N", "memory", "ns/sample/inst", "p99 us", "max us", "LLC miss", "L1D miss");
+        for (int n = 1; n <= max_instances; n *= 2)
+        {
+            size_t bytes_per_instance = 0;
+            const Result r = run(n, topology, sample_rate, block_size, seconds, bytes_per_instance);
+            std::printf("  %5d %8.1f MiB %15.3f %10.3f %10.3f", n, static_cast<double>(bytes_per_instance) * n / (1024. * 1024.),
+                        r.cpu_ns_per_sample_instance, r.p99_us, r.max_us);
+            print_misses(r.llc_misses);
+            print_misses(r.l1d_misses);
+            std::printf("\n");
+        }
+    }
+
+    return 0;
+}
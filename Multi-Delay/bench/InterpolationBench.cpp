@@ -0,0 +1,130 @@
+// Benchmark delle interpolazioni delle letture dalla linea di ritardo
+// Per ogni interpolazione (none, linear, hermite, lagrange, allpass) misura, in nanosecondi per campione stereo:
+//      - read kernel: solo InterleavedDelayLine::ReadBlock con un ritardo diverso per ogni campione
+//      - process (static): Delay::process con ritardo fermo
+//      - process (moving): Delay::process con il ritardo sempre in rampa
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "Delay.h"
+#include "BenchUtils.h"
+#include <random>
+#include <vector>
+
+#define SAMPLE_RATE 48000.
+#define BLOCK_SIZE 512                                                          // Campioni per blocco di Delay::process
+#define KERNEL_BLOCK_SIZE 64                                                    // Frame per chiamata a ReadBlock (come i sotto-blocchi di Delay)
+#define NUM_BLOCKS 2000                                                         // Blocchi elaborati per ogni misura
+#define MAX_DELAY_MS 500.f
+#define LINE_FRAMES 32768                                                       // Frame della linea per la misura dei kernel
+
+static void fill_noise(juce::AudioBuffer<float>& buffer, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    for (int ch = 0; ch < buffer.getNumChannels(); ch++)
+        for (int i = 0; i < buffer.getNumSamples(); i++)
+            buffer.getWritePointer(ch)[i] = dist(rng);
+}
+
+// Solo le letture: un ritardo modulato diverso per ogni campione, la linea è già tutta scritta
+template <typename Interpolator>
+static double kernel_ns_per_sample(Interpolator& interpolator)
+{
+    std::vector<float> memory(daisysp::InterleavedDelayLine<float, 2>::BufferSize(LINE_FRAMES));
+    daisysp::InterleavedDelayLine<float, 2> line;
+    line.Init(memory.data(), LINE_FRAMES);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    float input_left[KERNEL_BLOCK_SIZE], input_right[KERNEL_BLOCK_SIZE];
+    for (int i = 0; i < KERNEL_BLOCK_SIZE; i++)
+    {
+        input_left[i] = dist(rng);
+        input_right[i] = dist(rng);
+    }
+    const float* inputs[2] = { input_left, input_right };
+    for (int b = 0; b < LINE_FRAMES / KERNEL_BLOCK_SIZE; b++)
+        line.WriteBlock(inputs, KERNEL_BLOCK_SIZE);
+
+    float delay_left[KERNEL_BLOCK_SIZE], delay_right[KERNEL_BLOCK_SIZE];
+    for (int i = 0; i < KERNEL_BLOCK_SIZE; i++)
+    {
+        delay_left[i] = 7200.f + 0.37f * static_cast<float>(i);
+        delay_right[i] = 4800.f - 0.21f * static_cast<float>(i);
+    }
+    const float* delays[2] = { delay_left, delay_right };
+
+    float out_left[KERNEL_BLOCK_SIZE], out_right[KERNEL_BLOCK_SIZE];
+    float* outs[2] = { out_left, out_right };
+
+    const int num_reads = NUM_BLOCKS * BLOCK_SIZE / KERNEL_BLOCK_SIZE;
+    Stopwatch sw;
+    for (int b = 0; b < num_reads; b++)
+    {
+        line.ReadBlock(outs, delays, KERNEL_BLOCK_SIZE, interpolator);
+        do_not_optimize(out_left[0]);
+        line.WriteBlock(inputs, KERNEL_BLOCK_SIZE);
+    }
+    return sw.elapsed_ns() / (static_cast<double>(num_reads) * KERNEL_BLOCK_SIZE);
+}
+
+// Delay::process completo; con moving il ritardo viene spostato ad ogni blocco e resta sempre in rampa
+static double process_ns_per_sample(int interpolation, bool moving, const juce::AudioBuffer<float>& input)
+{
+    Delay<float> delay;
+    delay.prepare(SAMPLE_RATE, BLOCK_SIZE, MAX_DELAY_MS);
+    delay.set_interpolation(interpolation);
+    delay.set_delay_sx_in_ms(150.f);
+    delay.set_delay_dx_in_ms(100.f);
+    delay.set_feedback(0.5f);
+    delay.set_dry_wet(0.5f);
+
+    juce::AudioBuffer<float> buffer(2, BLOCK_SIZE);
+    Stopwatch sw;
+    for (int b = 0; b < NUM_BLOCKS; b++)
+    {
+        if (moving)
+        {
+            delay.set_delay_sx_in_ms((b % 2) ? 150.f : 160.f);
+            delay.set_delay_dx_in_ms((b % 2) ? 100.f : 90.f);
+        }
+        buffer.makeCopyOf(input, true);
+        delay.process(buffer);
+        do_not_optimize(buffer.getReadPointer(0)[0]);
+    }
+    return sw.elapsed_ns() / (static_cast<double>(NUM_BLOCKS) * BLOCK_SIZE);
+}
+
+int main()
+{
+    const char* names[] = { "none", "linear", "hermite", "lagrange", "allpass" };
+
+    daisysp::DelayInterpolateNone none;
+    daisysp::DelayInterpolateLinear linear;
+    daisysp::DelayInterpolateHermite hermite;
+    daisysp::DelayInterpolateLagrange lagrange;
+    daisysp::DelayInterpolateAllpass<float, 2> allpass;
+    const double kernel_ns[] = {
+        kernel_ns_per_sample(none),
+        kernel_ns_per_sample(linear),
+        kernel_ns_per_sample(hermite),
+        kernel_ns_per_sample(lagrange),
+        kernel_ns_per_sample(allpass),
+    };
+
+    std::mt19937 rng(1234);
+    juce::AudioBuffer<float> input(2, BLOCK_SIZE);
+    fill_noise(input, rng);
+
+    std::printf("Delay read interpolation, %d blocks of %d samples at %.0f Hz (ns/sample)\n", NUM_BLOCKS, BLOCK_SIZE, SAMPLE_RATE);
+    std::printf("  %-12s %14s %17s %17s\n", "interpolation", "read kernel", "process (static)", "process (moving)");
+
+    for (int interpolation = DelayTypes::interpolation_none; interpolation <= DelayTypes::interpolation_allpass; interpolation++)
+    {
+        const double static_ns = process_ns_per_sample(interpolation, false, input);
+        const double moving_ns = process_ns_per_sample(interpolation, true, input);
+        std::printf("  %-12s %14.3f %17.3f %17.3f\n", names[interpolation], kernel_ns[interpolation], static_ns, moving_ns);
+    }
+
+    return 0;
+}
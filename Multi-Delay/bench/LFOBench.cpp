@@ -0,0 +1,70 @@
+// Benchmark della generazione della forma d'onda dell'LFO
+// Per ogni forma d'onda (sine, saw, square) confronta, in nanosecondi per campione:
+//      - getNextValue: un valore per chiamata (std::sin e divisione rate / sampleRate ad ogni campione)
+//      - render: un blocco per chiamata (oscillatore in quadratura per la sinusoide, cicli vettorizzati per saw e square)
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "LFO.h"
+#include "BenchUtils.h"
+#include <vector>
+
+#define SAMPLE_RATE 48000.
+#define BLOCK_SIZE 512                                                          // Campioni per blocco
+#define NUM_BLOCKS 20000                                                        // Blocchi generati per ogni misura
+
+static LFO make_lfo(int shape)
+{
+    LFO lfo;
+    lfo.set_sample_rate(SAMPLE_RATE);
+    lfo.set_rate(2.5f);
+    lfo.set_amount(0.8f);
+    lfo.set_shape(shape);
+    return lfo;
+}
+
+static double next_value_ns_per_sample(int shape)
+{
+    LFO lfo = make_lfo(shape);
+    std::vector<float> output(BLOCK_SIZE);
+
+    Stopwatch sw;
+    for (int b = 0; b < NUM_BLOCKS; b++)
+    {
+        for (int i = 0; i < BLOCK_SIZE; i++)
+            output[i] = lfo.getNextValue(SAMPLE_RATE);
+        do_not_optimize(output[0]);
+    }
+    return sw.elapsed_ns() / (static_cast<double>(NUM_BLOCKS) * BLOCK_SIZE);
+}
+
+static double render_ns_per_sample(int shape)
+{
+    LFO lfo = make_lfo(shape);
+    std::vector<float> output(BLOCK_SIZE);
+
+    Stopwatch sw;
+    for (int b = 0; b < NUM_BLOCKS; b++)
+    {
+        lfo.render(output.data(), BLOCK_SIZE);
+        do_not_optimize(output[0]);
+    }
+    return sw.elapsed_ns() / (static_cast<double>(NUM_BLOCKS) * BLOCK_SIZE);
+}
+
+int main()
+{
+    const char* shapes[] = { "sine", "saw", "square" };
+
+    std::printf("LFO, %d blocks of %d samples at %.0f Hz (ns/sample)\n", NUM_BLOCKS, BLOCK_SIZE, SAMPLE_RATE);
+    std::printf("  %-10s %14s %10s %9s\n", "shape", "getNextValue", "render", "speedup");
+
+    for (int shape = LFO::shape_sine; shape <= LFO::shape_square; shape++)
+    {
+        const double next_value_ns = next_value_ns_per_sample(shape);
+        const double render_ns = render_ns_per_sample(shape);
+        std::printf("  %-10s %14.3f %10.3f %8.2fx\n", shapes[shape], next_value_ns, render_ns, next_value_ns / render_ns);
+    }
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+// Benchmark dei percorsi di elaborazione di Delay per modalità
+// Per ognuno dei cinque percorsi (feedback, feedback sincronizzato, pingpong center/left/right)
+// confronta, in nanosecondi per campione stereo:
+//      - legacy loop: il ciclo per campione originale (SetDelay/Read/Write e switch delle modalità ad ogni campione)
+//      - Delay::process: i kernel specializzati per modalità scelti una volta per blocco
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "Delay.h"
+#include "BenchUtils.h"
+#include <random>
+#include <vector>
+
+#define SAMPLE_RATE 48000.
+#define BLOCK_SIZE 512                                                          // Campioni per blocco
+#define NUM_BLOCKS 2000                                                         // Blocchi elaborati per ogni misura
+#define MAX_DELAY_MS 500.f
+
+// Riproduzione del ciclo per campione usato prima dei kernel specializzati
+class LegacyDelay
+{
+private:
+    daisysp::DelayLine<float, 0> _delay_left;
+    daisysp::DelayLine<float, 0> _delay_right;
+    std::vector<float> _buffer_left;
+    std::vector<float> _buffer_right;
+    juce::LinearSmoothedValue<float> _smooth_delay_left;
+    juce::LinearSmoothedValue<float> _smooth_delay_right;
+
+public:
+    float feedback = 0.5f;
+    float dry_wet = 0.5f;
+    bool sync_enable = false;
+    DelayTypes::Mode mode_delay = DelayTypes::mode_feedback;
+    DelayTypes::Mode_clr mode_pingpong = DelayTypes::mode_center;
+
+    void prepare(float delay_left, float delay_right)
+    {
+        const size_t capacity = daisysp::get_next_power2(static_cast<uint32_t>(MAX_DELAY_MS * SAMPLE_RATE / 1000. + 2));
+        _buffer_left.resize(capacity);
+        _buffer_right.resize(capacity);
+        _delay_left.Init(_buffer_left.data(), capacity);
+        _delay_right.Init(_buffer_right.data(), capacity);
+        _smooth_delay_left.setCurrentAndTargetValue(delay_left);
+        _smooth_delay_right.setCurrentAndTargetValue(delay_right);
+    }
+
+    void process(juce::AudioBuffer<float>& buffer)
+    {
+        float* left_channel = buffer.getWritePointer(0);
+        float* right_channel = buffer.getWritePointer(1);
+
+        for (int i = 0; i < buffer.getNumSamples(); i++)
+        {
+            float current_delay_left = _smooth_delay_left.getNextValue();
+            float current_delay_right = sync_enable ? current_delay_left : _smooth_delay_right.getNextValue();
+            _delay_left.SetDelay(current_delay_left);
+            _delay_right.SetDelay(current_delay_right);
+
+            float out_left = left_channel[i];
+            float out_right = right_channel[i];
+            float out_left_delay = _delay_left.Read();
+            float out_right_delay = _delay_right.Read();
+
+            left_channel[i] = out_left * (1.f - dry_wet) + out_left_delay * dry_wet;
+            right_channel[i] = out_right * (1.f - dry_wet) + out_right_delay * dry_wet;
+
+            switch (mode_delay)
+            {
+            case DelayTypes::mode_feedback:
+                _delay_left.Write(out_left + out_left_delay * feedback);
+                _delay_right.Write(out_right + out_right_delay * feedback);
+                break;
+
+            case DelayTypes::mode_pingpong:
+                switch (mode_pingpong)
+                {
+                case DelayTypes::mode_center:
+                    _delay_left.Write((out_left + out_right) / 2 + out_right_delay * feedback);
+                    _delay_right.Write((out_left + out_right) / 2 + out_left_delay * feedback);
+                    break;
+                case DelayTypes::mode_left:
+                    _delay_left.Write((out_left + out_right) / 2 + out_right_delay * feedback);
+                    _delay_right.Write(out_left_delay * feedback);
+                    break;
+                case DelayTypes::mode_right:
+                    _delay_left.Write(out_right_delay * feedback);
+                    _delay_right.Write((out_left + out_right) / 2 + out_left_delay * feedback);
+                    break;
+                }
+                break;
+            }
+        }
+    }
+};
+
+struct ModePath                                                                 // Percorso da misurare
+{
+    const char* name;
+    DelayTypes::Mode mode;
+    DelayTypes::Mode_clr pingpong;
+    bool sync;
+};
+
+static void fill_noise(juce::AudioBuffer<float>& buffer, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    for (int ch = 0; ch < buffer.getNumChannels(); ch++)
+        for (int i = 0; i < buffer.getNumSamples(); i++)
+            buffer.getWritePointer(ch)[i] = dist(rng);
+}
+
+template <typename Processor>
+static double ns_per_sample(Processor& processor, const juce::AudioBuffer<float>& input)
+{
+    juce::AudioBuffer<float> buffer(2, BLOCK_SIZE);
+    Stopwatch sw;
+    for (int b = 0; b < NUM_BLOCKS; b++)
+    {
+        buffer.makeCopyOf(input, true);
+        processor.process(buffer);
+        do_not_optimize(buffer.getReadPointer(0)[0]);
+    }
+    return sw.elapsed_ns() / (static_cast<double>(NUM_BLOCKS) * BLOCK_SIZE);
+}
+
+int main()
+{
+    const ModePath paths[] = {
+        { "feedback",          DelayTypes::mode_feedback, DelayTypes::mode_center, false },
+        { "feedback (sync)",   DelayTypes::mode_feedback, DelayTypes::mode_center, true },
+        { "pingpong center",   DelayTypes::mode_pingpong, DelayTypes::mode_center, false },
+        { "pingpong left",     DelayTypes::mode_pingpong, DelayTypes::mode_left,   false },
+        { "pingpong right",    DelayTypes::mode_pingpong, DelayTypes::mode_right,  false },
+    };
+
+    std::mt19937 rng(1234);
+    juce::AudioBuffer<float> input(2, BLOCK_SIZE);
+    fill_noise(input, rng);
+
+    std::printf("Delay mode paths, %d blocks of %d samples at %.0f Hz (ns/sample)\n", NUM_BLOCKS, BLOCK_SIZE, SAMPLE_RATE);
+    std::printf("  %-20s %14s %14s %9s\n", "path", "legacy loop", "Delay::process", "speedup");
+
+    for (const auto& path : paths)
+    {
+        LegacyDelay legacy;
+        legacy.mode_delay = path.mode;
+        legacy.mode_pingpong = path.pingpong;
+        legacy.sync_enable = path.sync;
+        legacy.prepare(150.f * SAMPLE_RATE / 1000.f, 100.f * SAMPLE_RATE / 1000.f);
+
+        Delay<float> delay;
+        delay.prepare(SAMPLE_RATE, BLOCK_SIZE, MAX_DELAY_MS);
+        delay.set_delay_mode(path.mode);
+        delay.set_pingpong_mode(path.pingpong);
+        delay.enable_sync(path.sync);
+        delay.set_delay_sx_in_ms(150.f);
+        delay.set_delay_dx_in_ms(100.f);
+        delay.set_feedback(0.5f);
+        delay.set_dry_wet(0.5f);
+
+        const double legacy_ns = ns_per_sample(legacy, input);
+        const double kernel_ns = ns_per_sample(delay, input);
+        std::printf("  %-20s %14.3f %14.3f %8.2fx\n", path.name, legacy_ns, kernel_ns, legacy_ns / kernel_ns);
+    }
+
+    return 0;
+}
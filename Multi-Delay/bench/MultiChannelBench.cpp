@@ -0,0 +1,80 @@
+// Benchmark del delay multicanale per layout surround e ambisonici
+// Per ogni numero di canali (5.1, 7.1.4, ambisonico del terzo ordine) misura, in nanosecondi per frame:
+//      - diagonal: feedback di ogni canale nella propria linea, un gruppo per canale
+//      - pairs: feedback incrociato tra coppie di canali (pingpong), un gruppo per coppia
+//      - full matrix: tutte le linee collegate, un solo gruppo
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "MultiChannelDelay.h"
+#include "BenchUtils.h"
+#include <random>
+#include <string>
+#include <vector>
+
+#define SAMPLE_RATE 48000.
+#define BLOCK_SIZE 512                                                          // Campioni per blocco
+#define NUM_BLOCKS 4000                                                         // Blocchi elaborati per ogni misura
+#define MAX_DELAY_MS 500.f
+
+enum class Topology { diagonal, pairs, full };
+
+static double ns_per_frame(int num_channels, Topology topology)
+{
+    MultiChannelDelay<float> delay;
+    delay.prepare(SAMPLE_RATE, num_channels, MAX_DELAY_MS);
+
+    std::vector<float> delays_in_ms(static_cast<size_t>(num_channels));
+    std::vector<float> routing(static_cast<size_t>(num_channels * num_channels), 0.f);
+    std::vector<float> feedback(static_cast<size_t>(num_channels * num_channels), 0.f);
+    for (int c = 0; c < num_channels; c++)
+    {
+        delays_in_ms[static_cast<size_t>(c)] = 100.f + 13.f * c;
+        routing[static_cast<size_t>(c * num_channels + c)] = 1.f;
+        const int partner = (topology == Topology::pairs && (c ^ 1) < num_channels) ? (c ^ 1) : c;   // Pingpong: feedback dal canale della coppia
+        for (int j = 0; j < num_channels; j++)
+        {
+            if (topology == Topology::full || j == partner)
+                feedback[static_cast<size_t>(c * num_channels + j)] = (topology == Topology::full) ? 0.5f / num_channels : 0.5f;
+        }
+    }
+    delay.set_delays_in_ms(delays_in_ms.data());
+    delay.set_routing_matrix(routing.data());
+    delay.set_feedback_matrix(feedback.data());
+    delay.set_dry_wet(0.5f);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    juce::AudioBuffer<float> input(num_channels, BLOCK_SIZE);
+    juce::AudioBuffer<float> buffer(num_channels, BLOCK_SIZE);
+    for (int ch = 0; ch < num_channels; ch++)
+        for (int i = 0; i < BLOCK_SIZE; i++)
+            input.getWritePointer(ch)[i] = dist(rng);
+
+    buffer.makeCopyOf(input, true);
+    delay.process(buffer);                                                      // Applica i parametri
+    delay.reset();                                                              // I ritardi saltano al valore impostato
+
+    Stopwatch sw;
+    for (int b = 0; b < NUM_BLOCKS; b++)
+    {
+        buffer.makeCopyOf(input, true);
+        delay.process(buffer);
+        do_not_optimize(buffer.getReadPointer(0)[0]);
+    }
+    return sw.elapsed_ns() / (static_cast<double>(NUM_BLOCKS) * BLOCK_SIZE);
+}
+
+int main()
+{
+    std::printf("MultiChannelDelay, %d blocks of %d samples at %.0f Hz (ns/frame)\n", NUM_BLOCKS, BLOCK_SIZE, SAMPLE_RATE);
+    for (int num_channels : { 6, 12, 16 })
+    {
+        const std::string name = std::to_string(num_channels) + " channels, ";
+        print_row((name + "diagonal").c_str(), ns_per_frame(num_channels, Topology::diagonal), "ns");
+        print_row((name + "pairs").c_str(), ns_per_frame(num_channels, Topology::pairs), "ns");
+        print_row((name + "full matrix").c_str(), ns_per_frame(num_channels, Topology::full), "ns");
+    }
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+// Benchmark del panning modulato campione per campione (auto-pan dell'LFO)
+// Confronta, in nanosecondi per campione stereo:
+//      - linear per-sample loop: il panning lineare per campione usato prima della tabella del seno
+//      - Pan::process (modulation): panning dalla tabella del seno, moltiplicazione SIMD dei due canali
+//      - Pan::process (constant): panning fisso fuori dal centro, un guadagno per canale
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "pan.h"
+#include "BenchUtils.h"
+#include <cmath>
+#include <random>
+#include <vector>
+
+#define SAMPLE_RATE 48000.
+#define BLOCK_SIZE 512                                                          // Campioni per blocco
+#define NUM_BLOCKS 20000                                                        // Blocchi elaborati per ogni misura
+
+// Riproduzione del panning lineare per campione
+static void linear_pan(juce::AudioBuffer<float>& buffer, float pan_value, const float* modulation)
+{
+    float* left = buffer.getWritePointer(0);
+    float* right = buffer.getWritePointer(1);
+    for (int i = 0; i < buffer.getNumSamples(); i++)
+    {
+        float pan = juce::jlimit(-1.0f, 1.0f, pan_value + modulation[i]);
+        left[i] *= juce::jmin(1.0f, 1.0f - pan);
+        right[i] *= juce::jmin(1.0f, 1.0f + pan);
+    }
+}
+
+template <typename Function>
+static double ns_per_sample(Function&& process)
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    juce::AudioBuffer<float> input(2, BLOCK_SIZE);
+    juce::AudioBuffer<float> buffer(2, BLOCK_SIZE);
+    for (int ch = 0; ch < 2; ch++)
+        for (int i = 0; i < BLOCK_SIZE; i++)
+            input.getWritePointer(ch)[i] = dist(rng);
+
+    Stopwatch sw;
+    for (int b = 0; b < NUM_BLOCKS; b++)
+    {
+        buffer.makeCopyOf(input, true);                                         // Senza copia il segnale scenderebbe nei denormali
+        process(buffer);
+        do_not_optimize(buffer.getReadPointer(0)[0]);
+    }
+    return sw.elapsed_ns() / (static_cast<double>(NUM_BLOCKS) * BLOCK_SIZE);
+}
+
+int main()
+{
+    std::vector<float> modulation(BLOCK_SIZE);                                  // Un periodo di LFO sinusoidale a piena ampiezza
+    for (int i = 0; i < BLOCK_SIZE; i++)
+        modulation[i] = 0.8f * std::sin(2.f * juce::MathConstants<float>::pi * i / BLOCK_SIZE);
+
+    Pan<float> modulated;
+    modulated.set_pan(0.1f);
+    modulated.prepare(SAMPLE_RATE);
+
+    Pan<float> constant;
+    constant.set_pan(0.3f);
+    constant.prepare(SAMPLE_RATE);
+
+    std::printf("Pan, %d blocks of %d samples at %.0f Hz (ns/sample)\n", NUM_BLOCKS, BLOCK_SIZE, SAMPLE_RATE);
+    print_row("linear per-sample loop (modulation)", ns_per_sample([&](juce::AudioBuffer<float>& buffer) { linear_pan(buffer, 0.1f, modulation.data()); }), "ns");
+    print_row("Pan::process (modulation)", ns_per_sample([&](juce::AudioBuffer<float>& buffer) { modulated.process(buffer, modulation.data()); }), "ns");
+    print_row("Pan::process (constant)", ns_per_sample([&](juce::AudioBuffer<float>& buffer) { constant.process(buffer); }), "ns");
+
+    return 0;
+}
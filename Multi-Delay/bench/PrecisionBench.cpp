@@ -0,0 +1,119 @@
+// Benchmark delle due istanze di Delay e Pan (singola e doppia precisione)
+// Per ogni percorso (modalità e interpolazione) confronta, in nanosecondi per campione stereo:
+//      - Delay<float>::process e Delay<double>::process con gli stessi parametri e lo stesso ingresso
+//      - Pan<float>::process e Pan<double>::process con il pan fuori dal centro
+// La linea di ritardo stereo in float usa il kernel SSE/NEON, quella in double i kernel generici
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "Delay.h"
+#include "pan.h"
+#include "BenchUtils.h"
+#include <random>
+
+#define SAMPLE_RATE 48000.
+#define BLOCK_SIZE 512                                                          // Campioni per blocco
+#define NUM_BLOCKS 2000                                                         // Blocchi elaborati per ogni misura
+#define MAX_DELAY_MS 500.f
+
+struct PrecisionPath                                                            // Percorso da misurare
+{
+    const char* name;
+    DelayTypes::Mode mode;
+    DelayTypes::Interpolation interpolation;
+    bool moving;                                                                // Ritardo sempre in rampa
+};
+
+template <typename SampleType>
+static void fill_noise(juce::AudioBuffer<SampleType>& buffer)
+{
+    std::mt19937 rng(1234);                                                     // Stesso ingresso per entrambe le precisioni
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    for (int ch = 0; ch < buffer.getNumChannels(); ch++)
+        for (int i = 0; i < buffer.getNumSamples(); i++)
+            buffer.getWritePointer(ch)[i] = static_cast<SampleType>(dist(rng));
+}
+
+template <typename SampleType>
+static double delay_ns_per_sample(const PrecisionPath& path)
+{
+    Delay<SampleType> delay;
+    delay.prepare(SAMPLE_RATE, BLOCK_SIZE, MAX_DELAY_MS);
+    delay.set_delay_mode(path.mode);
+    delay.set_interpolation(path.interpolation);
+    delay.set_delay_sx_in_ms(150.f);
+    delay.set_delay_dx_in_ms(100.f);
+    delay.set_feedback(0.5f);
+    delay.set_dry_wet(0.5f);
+    for (int tap = 0; tap < DelayTypes::max_taps; tap++)
+    {
+        delay.set_tap_delay_in_ms(tap, 60.f * (tap + 1));
+        delay.set_tap_feedback(tap, 0.2f);
+    }
+
+    juce::AudioBuffer<SampleType> input(2, BLOCK_SIZE);
+    juce::AudioBuffer<SampleType> buffer(2, BLOCK_SIZE);
+    fill_noise(input);
+
+    Stopwatch sw;
+    for (int b = 0; b < NUM_BLOCKS; b++)
+    {
+        if (path.moving)
+        {
+            delay.set_delay_sx_in_ms((b % 2) ? 150.f : 160.f);
+            delay.set_delay_dx_in_ms((b % 2) ? 100.f : 90.f);
+        }
+        buffer.makeCopyOf(input, true);
+        delay.process(buffer);
+        do_not_optimize(buffer.getReadPointer(0)[0]);
+    }
+    return sw.elapsed_ns() / (static_cast<double>(NUM_BLOCKS) * BLOCK_SIZE);
+}
+
+template <typename SampleType>
+static double pan_ns_per_sample()
+{
+    Pan<SampleType> pan;
+    pan.set_pan(0.3f);
+
+    juce::AudioBuffer<SampleType> input(2, BLOCK_SIZE);
+    juce::AudioBuffer<SampleType> buffer(2, BLOCK_SIZE);
+    fill_noise(input);
+
+    Stopwatch sw;
+    for (int b = 0; b < NUM_BLOCKS; b++)
+    {
+        buffer.makeCopyOf(input, true);                                         // Senza copia il segnale scenderebbe nei denormali
+        pan.process(buffer);
+        do_not_optimize(buffer.getReadPointer(0)[0]);
+    }
+    return sw.elapsed_ns() / (static_cast<double>(NUM_BLOCKS) * BLOCK_SIZE);
+}
+
+int main()
+{
+    const PrecisionPath paths[] = {
+        { "feedback linear",          DelayTypes::mode_feedback, DelayTypes::interpolation_linear,  false },
+        { "feedback linear (moving)", DelayTypes::mode_feedback, DelayTypes::interpolation_linear,  true },
+        { "feedback hermite",         DelayTypes::mode_feedback, DelayTypes::interpolation_hermite, false },
+        { "pingpong linear",          DelayTypes::mode_pingpong, DelayTypes::interpolation_linear,  false },
+        { "multitap linear",          DelayTypes::mode_multitap, DelayTypes::interpolation_linear,  false },
+        { "multitap allpass",         DelayTypes::mode_multitap, DelayTypes::interpolation_allpass, false },
+    };
+
+    std::printf("Sample precision, %d blocks of %d samples at %.0f Hz (ns/sample)\n", NUM_BLOCKS, BLOCK_SIZE, SAMPLE_RATE);
+    std::printf("  %-26s %10s %10s %9s\n", "path", "float", "double", "ratio");
+
+    for (const auto& path : paths)
+    {
+        const double float_ns = delay_ns_per_sample<float>(path);
+        const double double_ns = delay_ns_per_sample<double>(path);
+        std::printf("  %-26s %10.3f %10.3f %8.2fx\n", path.name, float_ns, double_ns, double_ns / float_ns);
+    }
+
+    const double pan_float_ns = pan_ns_per_sample<float>();
+    const double pan_double_ns = pan_ns_per_sample<double>();
+    std::printf("  %-26s %10.3f %10.3f %8.2fx\n", "pan", pan_float_ns, pan_double_ns, pan_double_ns / pan_float_ns);
+
+    return 0;
+}
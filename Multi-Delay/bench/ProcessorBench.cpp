@@ -0,0 +1,244 @@
+// Benchmark headless di AudioPluginAudioProcessor
+// Crea il processore senza editor e chiama processBlock con un segnale generato (sinusoide più rumore)
+// per ogni combinazione di sample rate, dimensione del blocco, modalità del delay/pingpong e forma dell'LFO.
+// Per ogni combinazione riporta:
+//      - ns/sample: tempo medio per campione stereo
+//      - RT factor: secondi di audio elaborati per secondo di calcolo
+//      - p50/p99/max: distribuzione del tempo di un processBlock, in microsecondi
+//      - con MULTIDELAY_STAGE_PROFILING, p50/p99 in cicli di LFO, Delay e Pan (getStageTimings)
+// Opzioni:
+//      --seconds <s>              secondi di audio misurati per combinazione (default 2)
+//      --sample-rates <r1,r2,..>  sample rate da provare (default 44100,48000,96000)
+//      --block-sizes <b1,b2,..>   dimensioni del blocco da provare (default 64,256,1024)
+//      --csv                      risultati in CSV, per confrontare un'esecuzione con una di riferimento
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "PluginProcessor.h"
+#include "BenchUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define NUM_CHANNELS 2
+#define WARMUP_BLOCKS 16                                                        // Blocchi non misurati dopo prepareToPlay
+#define SINE_FREQUENCY 440.
+#define LFO_AMOUNT 0.5f                                                         // Profondità della modulazione quando l'LFO è attivo
+#define STAGE_DRAIN_BLOCKS 256                                                  // Blocchi tra due letture delle misure degli stadi (coda da 1024)
+
+struct DelayConfig                                                              // Valori dei parametri delay-mode e pingpong-mode
+{
+    const char* label;
+    float delay_mode;
+    float pingpong_mode;
+};
+
+struct LfoConfig                                                                // Valori dei parametri amount e shape
+{
+    const char* label;
+    float amount;
+    float shape;
+};
+
+static const DelayConfig delay_configs[] = {
+    { "feedback", 0.f, 0.f },
+    { "pingpong center", 1.f, 0.f },
+    { "pingpong left", 1.f, 1.f },
+    { "pingpong right", 1.f, 2.f },
+    { "multitap", 2.f, 0.f },
+    { "fdn", 3.f, 0.f },
+};
+
+static const LfoConfig lfo_configs[] = {
+    { "off", 0.f, 0.f },
+    { "sine", LFO_AMOUNT, 0.f },
+    { "saw", LFO_AMOUNT, 1.f },
+    { "square", LFO_AMOUNT, 2.f },
+};
+
+struct Result
+{
+    double ns_per_sample;
+    double rt_factor;
+    double p50_us;
+    double p99_us;
+    double max_us;
+    bool has_stages;                                                            // Misure degli stadi disponibili
+    StageStats stages[StageProfiler::num_stages];
+    juce::int64 dropped_blocks;
+};
+
+static void set_parameter(juce::AudioProcessor& processor, const juce::String& id, float value)  // Imposta un parametro come farebbe un host
+{
+    for (auto* parameter : processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            if (ranged->paramID == id)
+                ranged->setValueNotifyingHost(ranged->convertTo0to1(value));
+}
+
+static std::vector<int> parse_list(const char* text)                            // "44100,48000" -> { 44100, 48000 }
+{
+    std::vector<int> values;
+    for (const char* p = text; *p != '\0';)
+    {
+        char* end = nullptr;
+        const long value = std::strtol(p, &end, 10);
+        if (end == p)                                                           // Non è un numero
+            break;
+        values.push_back(static_cast<int>(value));
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return values;
+}
+
+static void generate_input(juce::AudioBuffer<float>& input, double sample_rate)  // Sinusoide più rumore bianco, diverso per canale
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> noise(-0.1f, 0.1f);
+    for (int ch = 0; ch < input.getNumChannels(); ch++)
+    {
+        float* samples = input.getWritePointer(ch);
+        for (int i = 0; i < input.getNumSamples(); i++)
+            samples[i] = 0.5f * static_cast<float>(std::sin(2. * M_PI * SINE_FREQUENCY * i / sample_rate + ch)) + noise(rng);
+    }
+}
+
+static double percentile(std::vector<double>& sorted, double p)                 // Percentile di un vettore già ordinato
+{
+    const size_t index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+static Result run(const juce::AudioBuffer<float>& input, double sample_rate, int block_size, const DelayConfig& delay_config, const LfoConfig& lfo_config)
+{
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    set_parameter(*processor, "delay-mode", delay_config.delay_mode);
+    set_parameter(*processor, "pingpong-mode", delay_config.pingpong_mode);
+    set_parameter(*processor, "amount", lfo_config.amount);
+    set_parameter(*processor, "shape", lfo_config.shape);
+    set_parameter(*processor, "feedback", 0.7f);
+    processor->setRateAndBufferSizeDetails(sample_rate, block_size);
+    processor->prepareToPlay(sample_rate, block_size);                          // Applica i valori correnti dei parametri
+
+    juce::AudioBuffer<float> buffer(NUM_CHANNELS, block_size);
+    juce::MidiBuffer midi;
+    const int num_blocks = input.getNumSamples() / block_size;
+    std::vector<double> block_times(static_cast<size_t>(num_blocks));
+
+    auto process_block = [&](int block)
+    {
+        const int start = (block % num_blocks) * block_size;
+        for (int ch = 0; ch < NUM_CHANNELS; ch++)
+            buffer.copyFrom(ch, 0, input, ch, start, block_size);
+        Stopwatch sw;
+        processor->processBlock(buffer, midi);
+        const double elapsed = sw.elapsed_ns();
+        do_not_optimize(buffer.getReadPointer(0)[0]);
+        return elapsed;
+    };
+
+    for (int block = 0; block < WARMUP_BLOCKS; block++)
+        process_block(block);
+    processor->resetStageTimings();
+
+    Result result;
+    double total_ns = 0.;
+    for (int block = 0; block < num_blocks; block++)
+    {
+        block_times[static_cast<size_t>(block)] = process_block(block);
+        total_ns += block_times[static_cast<size_t>(block)];
+        if ((block + 1) % STAGE_DRAIN_BLOCKS == 0)                              // Fuori dal tempo misurato
+            processor->getStageTimings(result.stages);
+    }
+    result.has_stages = processor->getStageTimings(result.stages, &result.dropped_blocks);
+    processor->releaseResources();
+
+    std::sort(block_times.begin(), block_times.end());
+    const double num_samples = static_cast<double>(num_blocks) * block_size;
+
+    result.ns_per_sample = total_ns / num_samples;
+    result.rt_factor = (num_samples / sample_rate) / (total_ns * 1e-9);
+    result.p50_us = percentile(block_times, 0.50) * 1e-3;
+    result.p99_us = percentile(block_times, 0.99) * 1e-3;
+    result.max_us = block_times.back() * 1e-3;
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juce_initialiser;                           // Message manager per AudioProcessorValueTreeState
+
+    double seconds = 2.;
+    std::vector<int> sample_rates = { 44100, 48000, 96000 };
+    std::vector<int> block_sizes = { 64, 256, 1024 };
+    bool csv = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+            seconds = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--sample-rates") == 0 && i + 1 < argc)
+            sample_rates = parse_list(argv[++i]);
+        else if (std::strcmp(argv[i], "--block-sizes") == 0 && i + 1 < argc)
+            block_sizes = parse_list(argv[++i]);
+        else if (std::strcmp(argv[i], "--csv") == 0)
+            csv = true;
+        else
+        {
+            std::printf("usage: %s [--seconds s] [--sample-rates r1,r2,..] [--block-sizes b1,b2,..] [--csv]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (csv)
+        std::printf("sample_rate,block_size,delay_mode,lfo,ns_per_sample,rt_factor,p50_us,p99_us,max_us\n");
+    else
+        std::printf("AudioPluginAudioProcessor::processBlock, %.1f s of stereo audio per configuration\n", seconds);
+
+    for (int sample_rate : sample_rates)
+    {
+        if (sample_rate <= 0)
+            continue;
+        for (int block_size : block_sizes)
+        {
+            if (block_size <= 0)
+                continue;
+            const int num_blocks = std::max(1, static_cast<int>(seconds * sample_rate) / block_size);
+            juce::AudioBuffer<float> input(NUM_CHANNELS, num_blocks * block_size);
+            generate_input(input, sample_rate);
+
+            if (!csv)
+                std::printf("\n%d Hz, %d samples per block\n  %-16s %-7s %10s %10s %9s %9s %9s\n", sample_rate, block_size,
+                            "mode", "lfo", "ns/sample", "RT factor", "p50 us", "p99 us", "max us");
+
+            for (const auto& delay_config : delay_configs)
+                for (const auto& lfo_config : lfo_configs)
+                {
+                    const Result r = run(input, sample_rate, block_size, delay_config, lfo_config);
+                    if (csv)
+                        std::printf("%d,%d,%s,%s,%.3f,%.1f,%.3f,%.3f,%.3f\n", sample_rate, block_size, delay_config.label, lfo_config.label,
+                                    r.ns_per_sample, r.rt_factor, r.p50_us, r.p99_us, r.max_us);
+                    else
+                    {
+                        std::printf("  %-16s %-7s %10.3f %10.1f %9.3f %9.3f %9.3f\n", delay_config.label, lfo_config.label,
+                                    r.ns_per_sample, r.rt_factor, r.p50_us, r.p99_us, r.max_us);
+                        if (r.has_stages)
+                        {
+                            std::printf("  %-24s", "cycles p50/p99");
+                            for (int stage = 0; stage < StageProfiler::num_stages; stage++)
+                                if (r.stages[stage].count > 0)
+                                    std::printf(" %s %llu/%llu", StageProfiler::get_stage_name(stage),
+                                                static_cast<unsigned long long>(r.stages[stage].p50), static_cast<unsigned long long>(r.stages[stage].p99));
+                            std::printf(r.dropped_blocks > 0 ? " (%lld blocks dropped)\n" : "\n", static_cast<long long>(r.dropped_blocks));
+                        }
+                    }
+                }
+        }
+    }
+
+    return 0;
+}
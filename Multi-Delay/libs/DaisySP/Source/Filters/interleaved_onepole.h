@@ -0,0 +1,126 @@
+/*
+Copyright (c) 2025 Multi-Delay contributors
+
+Local addition to DaisySP, not part of the upstream library.
+The filter (coefficient and recursion) is derived from OnePole,
+Copyright (c) 2020 Electrosmith, Corp, Emilie Gillet.
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_INTERLEAVED_ONEPOLE_H
+#define DSY_INTERLEAVED_ONEPOLE_H
+#include <stdlib.h>
+#include <cmath>
+#include "Utility/dsp.h"
+#include "Filters/onepole.h"
+
+namespace daisysp
+{
+/** One pole lowpass / highpass filter for several channels at once.
+
+    Same filter as OnePole (one coefficient shared by all the channels),
+    processed a block at a time: the per-sample function call and the mode
+    switch of OnePole::Process() are hoisted out of the loop, and the
+    channels are processed together frame by frame so that their
+    independent recursions overlap.
+
+    The sample type T is the type of the processed samples and of the
+    filter state (float or double).
+
+    declaration example (stereo):
+
+    InterleavedOnePole<float, 2> filter;
+    filter.Init();
+    filter.SetFrequency(1000.f / sample_rate);
+    filter.ProcessBlock(channels, n);
+*/
+template <typename T, size_t num_channels>
+class InterleavedOnePole
+{
+  public:
+    InterleavedOnePole() {}
+    ~InterleavedOnePole() {}
+
+    /** Initializes the module: lowpass, cleared state, cutoff near Nyquist */
+    void Init()
+    {
+        Reset();
+        mode_ = OnePole::FILTER_MODE_LOW_PASS;
+        SetFrequency(0.497f);
+    }
+
+    /** Reset the state of every channel */
+    inline void Reset()
+    {
+        for(size_t ch = 0; ch < num_channels; ch++)
+            state_[ch] = T(0);
+    }
+
+    /** Set the filter cutoff frequency
+    *   \param freq Cutoff frequency divided by the sample rate. Valid range from 0 to .497f
+    */
+    inline void SetFrequency(float freq)
+    {
+        // Clip coefficient to about 100.
+        freq = freq < 0.497f ? freq : 0.497f;
+
+        g_  = static_cast<T>(tanf(PI_F * freq));
+        gi_ = T(1) / (T(1) + g_);
+    }
+
+    /** Set the filter mode
+    *   \param mode Filter mode. Can be lowpass or highpass
+    */
+    inline void SetFilterMode(OnePole::FilterMode mode) { mode_ = mode; }
+
+    /** Process a block of audio of every channel in place
+    *   \param in_out One pointer per channel to the block of samples to be processed
+    *   \param size Size of the block of samples to be processed.
+    */
+    inline void ProcessBlock(T* const* in_out, size_t size)
+    {
+        if(mode_ == OnePole::FILTER_MODE_LOW_PASS)
+            ProcessBlockMode<true>(in_out, size);
+        else
+            ProcessBlockMode<false>(in_out, size);
+    }
+
+  private:
+    template <bool low_pass>
+    inline void ProcessBlockMode(T* const* in_out, size_t size)
+    {
+        // local copies: the state stays in registers for the whole block
+        const T g  = g_;
+        const T gi = gi_;
+        T       state[num_channels];
+        for(size_t ch = 0; ch < num_channels; ch++)
+            state[ch] = state_[ch];
+
+        for(size_t i = 0; i < size; i++)
+        {
+            for(size_t ch = 0; ch < num_channels; ch++)
+            {
+                const T in    = in_out[ch][i];
+                const T lp    = (g * in + state[ch]) * gi;
+                state[ch]     = g * (in - lp) + lp;
+                in_out[ch][i] = low_pass ? lp : in - lp;
+            }
+        }
+
+        for(size_t ch = 0; ch < num_channels; ch++)
+            state_[ch] = state[ch];
+    }
+
+    T                   g_;
+    T                   gi_;
+    T                   state_[num_channels];
+    OnePole::FilterMode mode_;
+};
+
+} // namespace daisysp
+
+#endif // DSY_INTERLEAVED_ONEPOLE_H
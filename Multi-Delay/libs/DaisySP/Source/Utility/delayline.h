@@ -11,8 +11,62 @@ https://opensource.org/licenses/MIT.
 #define DSY_DELAY_H
 #include <stdlib.h>
 #include <stdint.h>
+#include <algorithm>
+#include "Utility/dsp.h"
 namespace daisysp
 {
+/** Smallest power of two not less than n (n > 0).
+    A single recursive return so that it is constexpr in C++11 as well,
+    unlike get_next_power2() in dsp.h.
+*/
+constexpr size_t delay_line_capacity(size_t n, size_t p = 1)
+{
+    return p >= n ? p : delay_line_capacity(n, p << 1);
+}
+
+/** Storage of a DelayLine sized at compile time.
+    The buffer is rounded up to the next power of two so that
+    index wrapping is a bitwise and instead of a modulo.
+    This costs memory: up to almost twice max_size samples. For example
+    DelayLine<float, 192000> takes 262144 samples (1 MiB instead of 750 KiB),
+    and the 2400 sample lines of Chorus and Phaser take 4096. Sizes that are
+    already a power of two are unchanged. When memory matters, use the
+    runtime sized DelayLine<T, 0>, whose capacity the caller chooses.
+    Reset() clears the whole buffer, as upstream, so reads never check
+    whether a sample was written.
+*/
+template <typename T, size_t max_size>
+class DelayLineStorage
+{
+  protected:
+    inline size_t MaxSize() const { return max_size; }
+    inline size_t Capacity() const { return kCapacity; }
+    inline size_t Mask() const { return Capacity() - 1; }
+
+    static constexpr bool   kLazyReset = false;
+    static constexpr size_t kCapacity  = delay_line_capacity(max_size);
+    T                       line_[kCapacity];
+};
+
+/** Storage of a DelayLine sized at runtime.
+    The memory is supplied by the user through Init(buffer, size),
+    size must be a power of two.
+    Reset() is O(1): the buffer is not cleared, samples that were not
+    written since the last Reset() are read as zero instead.
+*/
+template <typename T>
+class DelayLineStorage<T, 0>
+{
+  protected:
+    inline size_t MaxSize() const { return capacity_; }
+    inline size_t Capacity() const { return capacity_; }
+    inline size_t Mask() const { return capacity_ - 1; }
+
+    static constexpr bool kLazyReset = true;
+    T*                    line_      = nullptr;
+    size_t                capacity_  = 0;
+};
+
 /** Simple Delay line.
 November 2019
 
@@ -22,27 +76,48 @@ declaration example: (1 second of floats)
 
 DelayLine<float, SAMPLE_RATE> del;
 
+runtime sized (user supplied buffer of a power of two size):
+
+DelayLine<float, 0> del;
+del.Init(buffer, size);
+
 By: shensley
 */
 template <typename T, size_t max_size>
-class DelayLine
+class DelayLine : private DelayLineStorage<T, max_size>
 {
   public:
     DelayLine() {}
     ~DelayLine() {}
-    /** initializes the delay line by clearing the values within, and setting delay to 1 sample.
+    /** initializes the delay line by clearing the values within (see Reset()), and setting delay to 1 sample.
     */
     void Init() { Reset(); }
+    /** initializes a runtime sized delay line (DelayLine<T, 0>) on a buffer.
+        \param buffer Memory for the delay line, owned by the caller
+        \param size Number of samples in buffer, must be a power of two
+    */
+    void Init(T* buffer, size_t size)
+    {
+        static_assert(max_size == 0, "only DelayLine<T, 0> takes a buffer");
+        assert(is_power2(static_cast<uint32_t>(size)));
+        this->line_     = buffer;
+        this->capacity_ = size;
+        Reset();
+    }
     /** clears buffer, sets write ptr to 0, and delay to 1 sample.
+        For DelayLine<T, 0> clearing is lazy: the memory is not touched,
+        samples that were not written since the last Reset() are read as zero.
     */
     void Reset()
     {
-        for(size_t i = 0; i < max_size; i++)
+        if(!kLazyReset)
         {
-            line_[i] = T(0);
+            std::fill(line_, line_ + Capacity(), T(0));
         }
+        written_   = kLazyReset ? 0 : Capacity();
         write_ptr_ = 0;
         delay_     = 1;
+        frac_      = 0.0f;
     }
 
     /** sets the delay time in samples
@@ -51,7 +126,7 @@ class DelayLine
     inline void SetDelay(size_t delay)
     {
         frac_  = 0.0f;
-        delay_ = delay < max_size ? delay : max_size - 1;
+        delay_ = delay < MaxSize() ? delay : MaxSize() - 1;
     }
 
     /** sets the delay time in samples
@@ -61,8 +136,8 @@ class DelayLine
     {
         int32_t int_delay = static_cast<int32_t>(delay);
         frac_             = delay - static_cast<float>(int_delay);
-        delay_ = static_cast<size_t>(int_delay) < max_size ? int_delay
-                                                           : max_size - 1;
+        delay_ = static_cast<size_t>(int_delay) < MaxSize() ? int_delay
+                                                            : MaxSize() - 1;
     }
 
     /** writes the sample of type T to the delay line, and advances the write ptr
@@ -70,15 +145,19 @@ class DelayLine
     inline void Write(const T sample)
     {
         line_[write_ptr_] = sample;
-        write_ptr_        = (write_ptr_ - 1 + max_size) % max_size;
+        write_ptr_        = (write_ptr_ + 1) & Mask();
+        if(kLazyReset && written_ < Capacity())
+        {
+            written_++;
+        }
     }
 
     /** returns the next sample of type T in the delay line, interpolated if necessary.
     */
     inline const T Read() const
     {
-        T a = line_[(write_ptr_ + delay_) % max_size];
-        T b = line_[(write_ptr_ + delay_ + 1) % max_size];
+        T a = Tap(delay_);
+        T b = Tap(delay_ + 1);
         return a + (b - a) * frac_;
     }
 
@@ -87,8 +166,9 @@ class DelayLine
     {
         int32_t delay_integral   = static_cast<int32_t>(delay);
         float   delay_fractional = delay - static_cast<float>(delay_integral);
-        const T a = line_[(write_ptr_ + delay_integral) % max_size];
-        const T b = line_[(write_ptr_ + delay_integral + 1) % max_size];
+        const size_t d = static_cast<size_t>(delay_integral);
+        const T      a = Tap(d);
+        const T      b = Tap(d + 1);
         return a + (b - a) * delay_fractional;
     }
 
@@ -97,33 +177,167 @@ class DelayLine
         int32_t delay_integral   = static_cast<int32_t>(delay);
         float   delay_fractional = delay - static_cast<float>(delay_integral);
 
-        int32_t     t     = (write_ptr_ + delay_integral + max_size);
-        const T     xm1   = line_[(t - 1) % max_size];
-        const T     x0    = line_[(t) % max_size];
-        const T     x1    = line_[(t + 1) % max_size];
-        const T     x2    = line_[(t + 2) % max_size];
-        const float c     = (x1 - xm1) * 0.5f;
-        const float v     = x0 - x1;
-        const float w     = c + v;
-        const float a     = w + v + (x2 - x0) * 0.5f;
-        const float b_neg = w + a;
-        const float f     = delay_fractional;
+        const size_t d     = static_cast<size_t>(delay_integral);
+        const T      xm1   = Tap(d - 1);
+        const T      x0    = Tap(d);
+        const T      x1    = Tap(d + 1);
+        const T      x2    = Tap(d + 2);
+        const float  c     = (x1 - xm1) * 0.5f;
+        const float  v     = x0 - x1;
+        const float  w     = c + v;
+        const float  a     = w + v + (x2 - x0) * 0.5f;
+        const float  b_neg = w + a;
+        const float  f     = delay_fractional;
         return (((a * f) - b_neg) * f + c) * f + x0;
     }
 
     inline const T Allpass(const T sample, size_t delay, const T coefficient)
     {
-        T read  = line_[(write_ptr_ + delay) % max_size];
+        T read  = Tap(delay);
         T write = sample + coefficient * read;
         Write(write);
         return -write * coefficient + read;
     }
 
+    /** Reads a block of n interpolated samples, one per sample of the block.
+        Sample i is read as if i samples had already been written, so it
+        matches calling Read(delays[i]) followed by Write() n times.
+        Every delays[i] must be at least n for the block to only see samples
+        written before the call (i.e. before the matching WriteBlock).
+        \param dst Destination buffer of n samples
+        \param delays Delay time in samples for each sample of the block
+        \param n Number of samples to read
+    */
+    inline void ReadBlock(T* dst, const float* delays, size_t n) const
+    {
+        if(kLazyReset && written_ < Capacity())
+        {
+            ReadBlockAfterReset(dst, delays, 1, n);
+            return;
+        }
+        for(size_t i = 0; i < n; i++)
+        {
+            const int32_t delay_integral = static_cast<int32_t>(delays[i]);
+            const float   delay_fractional
+                = delays[i] - static_cast<float>(delay_integral);
+            const size_t t
+                = write_ptr_ + i - static_cast<size_t>(delay_integral);
+            const T a = line_[t & Mask()];
+            const T b = line_[(t - 1) & Mask()];
+            dst[i]    = a + (b - a) * delay_fractional;
+        }
+    }
+
+    /** Reads a block of n interpolated samples at a constant delay.
+        The read positions are contiguous, so the block is split into at most
+        a few spans that are processed without any index wrapping.
+        \param dst Destination buffer of n samples
+        \param delay Delay time in samples, at least n (see above)
+        \param n Number of samples to read
+    */
+    inline void ReadBlock(T* dst, float delay, size_t n) const
+    {
+        if(kLazyReset && written_ < Capacity())
+        {
+            ReadBlockAfterReset(dst, &delay, 0, n);
+            return;
+        }
+        const int32_t delay_integral = static_cast<int32_t>(delay);
+        const float   delay_fractional
+            = delay - static_cast<float>(delay_integral);
+        size_t pos
+            = (write_ptr_ - static_cast<size_t>(delay_integral)) & Mask();
+        while(n > 0)
+        {
+            if(pos == 0)
+            {
+                // the older neighbour of the first slot wraps to the end
+                const T a = line_[0];
+                const T b = line_[Mask()];
+                *dst++    = a + (b - a) * delay_fractional;
+                pos       = 1;
+                n--;
+                continue;
+            }
+            const size_t span = std::min(n, Capacity() - pos);
+            const T*     a    = line_ + pos;
+            const T*     b    = a - 1;
+            for(size_t i = 0; i < span; i++)
+            {
+                dst[i] = a[i] + (b[i] - a[i]) * delay_fractional;
+            }
+            dst += span;
+            n -= span;
+            pos = (pos + span) & Mask();
+        }
+    }
+
+    /** Writes a block of n samples and advances the write ptr by n.
+        Equivalent to n calls to Write(), done as contiguous copies.
+        \param src Source buffer of n samples
+        \param n Number of samples to write
+    */
+    inline void WriteBlock(const T* src, size_t n)
+    {
+        while(n > 0)
+        {
+            const size_t span = std::min(n, Capacity() - write_ptr_);
+            std::copy(src, src + span, line_ + write_ptr_);
+            write_ptr_ = (write_ptr_ + span) & Mask();
+            written_   = std::min(written_ + span, Capacity());
+            src += span;
+            n -= span;
+        }
+    }
+
   private:
+    using DelayLineStorage<T, max_size>::MaxSize;
+    using DelayLineStorage<T, max_size>::Capacity;
+    using DelayLineStorage<T, max_size>::Mask;
+    using DelayLineStorage<T, max_size>::line_;
+    using DelayLineStorage<T, max_size>::kLazyReset;
+
+    /** returns the sample written delay samples ago,
+        or zero if that sample was not written since the last Reset().
+        Fixed size lines and lines written completely since the last Reset()
+        read the buffer directly.
+    */
+    inline T Tap(size_t delay) const
+    {
+        if(!kLazyReset || written_ == Capacity())
+        {
+            return line_[(write_ptr_ - delay) & Mask()];
+        }
+        const size_t age = ((delay - 1) & Mask()) + 1;
+        return age <= written_ ? line_[(write_ptr_ - delay) & Mask()] : T(0);
+    }
+
+    /** ReadBlock() while the line is not completely written since Reset().
+        delays has n entries, or a single one if stride is 0.
+    */
+    inline void ReadBlockAfterReset(T*           dst,
+                                    const float* delays,
+                                    size_t       stride,
+                                    size_t       n) const
+    {
+        for(size_t i = 0; i < n; i++)
+        {
+            const float   delay          = delays[i * stride];
+            const int32_t delay_integral = static_cast<int32_t>(delay);
+            const float   delay_fractional
+                = delay - static_cast<float>(delay_integral);
+            // sample i is read i writes later, so it is i samples closer
+            const size_t d = static_cast<size_t>(delay_integral) - i;
+            const T      a = Tap(d);
+            const T      b = Tap(d + 1);
+            dst[i]         = a + (b - a) * delay_fractional;
+        }
+    }
+
     float  frac_;
     size_t write_ptr_;
     size_t delay_;
-    T      line_[max_size];
+    size_t written_ = 0;
 };
 } // namespace daisysp
 #endif
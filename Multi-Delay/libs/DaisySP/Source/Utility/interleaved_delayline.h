@@ -0,0 +1,596 @@
+/*
+Copyright (c) 2025 Multi-Delay contributors
+
+Local addition to DaisySP, not part of the upstream library.
+The read/write conventions and the interpolation follow DelayLine,
+Copyright (c) 2020 Electrosmith, Corp.
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_INTERLEAVED_DELAY_H
+#define DSY_INTERLEAVED_DELAY_H
+#include <stdlib.h>
+#include <stdint.h>
+#include <algorithm>
+#include "Utility/dsp.h"
+
+#if defined(__SSE__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define DSY_INTERLEAVED_DELAY_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DSY_INTERLEAVED_DELAY_NEON 1
+#endif
+
+namespace daisysp
+{
+/** Per-frame kernels of InterleavedDelayLine.
+    frames points to frame 0 of the line, frame -1 is a copy of the last
+    frame so that the older neighbour of any frame is at a fixed offset.
+*/
+template <typename T, size_t num_channels>
+struct InterleavedDelayKernel
+{
+    /** Interpolated read of frame i for every channel. */
+    static inline void Read(const T*            frames,
+                            size_t              mask,
+                            size_t              write_ptr,
+                            T* const*           dst,
+                            const float* const* delays,
+                            size_t              i)
+    {
+        for(size_t ch = 0; ch < num_channels; ch++)
+        {
+            const int32_t delay_integral = static_cast<int32_t>(delays[ch][i]);
+            const float   delay_fractional
+                = delays[ch][i] - static_cast<float>(delay_integral);
+            const size_t pos
+                = (write_ptr + i - static_cast<size_t>(delay_integral)) & mask;
+            const T a  = frames[pos * num_channels + ch];
+            const T b  = (frames - num_channels)[pos * num_channels + ch];
+            dst[ch][i] = a + (b - a) * delay_fractional;
+        }
+    }
+
+    /** Reads n contiguous frames starting at frame pos, every channel at
+        the same constant delay (fractional part frac).
+    */
+    static inline void ReadSpan(const T*  frames,
+                                size_t    pos,
+                                float     frac,
+                                T* const* dst,
+                                size_t    offset,
+                                size_t    n)
+    {
+        const T* a = frames + pos * num_channels;
+        const T* b = a - num_channels;
+        for(size_t i = 0; i < n; i++)
+        {
+            for(size_t ch = 0; ch < num_channels; ch++)
+            {
+                const size_t k      = i * num_channels + ch;
+                dst[ch][offset + i] = a[k] + (b[k] - a[k]) * frac;
+            }
+        }
+    }
+
+    /** Interleaves n frames from src into frames starting at frame pos. */
+    static inline void Write(T*              frames,
+                             size_t          pos,
+                             const T* const* src,
+                             size_t          offset,
+                             size_t          n)
+    {
+        T* out = frames + pos * num_channels;
+        for(size_t i = 0; i < n; i++)
+        {
+            for(size_t ch = 0; ch < num_channels; ch++)
+            {
+                *out++ = src[ch][offset + i];
+            }
+        }
+    }
+};
+
+#if defined(DSY_INTERLEAVED_DELAY_SSE) || defined(DSY_INTERLEAVED_DELAY_NEON)
+/** Stereo float kernels: one 4 lane load per channel brings in both the
+    frame and its older neighbour, left and right are interpolated together.
+    Constant delay spans are read four frames at a time and deinterleaved.
+*/
+template <>
+struct InterleavedDelayKernel<float, 2>
+{
+    static inline void Read(const float*        frames,
+                            size_t              mask,
+                            size_t              write_ptr,
+                            float* const*       dst,
+                            const float* const* delays,
+                            size_t              i)
+    {
+        const float   dl  = delays[0][i];
+        const float   dr  = delays[1][i];
+        const int32_t dli = static_cast<int32_t>(dl);
+        const int32_t dri = static_cast<int32_t>(dr);
+        const float   fl  = dl - static_cast<float>(dli);
+        const float   fr  = dr - static_cast<float>(dri);
+        const size_t pl = (write_ptr + i - static_cast<size_t>(dli)) & mask;
+        const size_t pr = (write_ptr + i - static_cast<size_t>(dri)) & mask;
+
+#if defined(DSY_INTERLEAVED_DELAY_SSE)
+        // [Lb Rb La Ra] around the left and the right read positions
+        const __m128 vl = _mm_loadu_ps(frames - 2 + 2 * pl);
+        const __m128 vr = _mm_loadu_ps(frames - 2 + 2 * pr);
+        // a = [La La Ra Ra], b = [Lb Lb Rb Rb]
+        const __m128 a   = _mm_shuffle_ps(vl, vr, _MM_SHUFFLE(3, 3, 2, 2));
+        const __m128 b   = _mm_shuffle_ps(vl, vr, _MM_SHUFFLE(1, 1, 0, 0));
+        const __m128 f   = _mm_setr_ps(fl, fl, fr, fr);
+        const __m128 out = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), f));
+        dst[0][i]        = _mm_cvtss_f32(out);
+        dst[1][i]        = _mm_cvtss_f32(_mm_movehl_ps(out, out));
+#else
+        const float32x4_t vl = vld1q_f32(frames - 2 + 2 * pl);
+        const float32x4_t vr = vld1q_f32(frames - 2 + 2 * pr);
+        // a = [La Ra], b = [Lb Rb]
+        const float32x2_t a
+            = vset_lane_f32(vgetq_lane_f32(vr, 3), vget_high_f32(vl), 1);
+        const float32x2_t b
+            = vset_lane_f32(vgetq_lane_f32(vr, 1), vget_low_f32(vl), 1);
+        const float32x2_t f   = vset_lane_f32(fr, vdup_n_f32(fl), 1);
+        const float32x2_t out = vmla_f32(a, vsub_f32(b, a), f);
+        dst[0][i]             = vget_lane_f32(out, 0);
+        dst[1][i]             = vget_lane_f32(out, 1);
+#endif
+    }
+
+    static inline void ReadSpan(const float*  frames,
+                                size_t        pos,
+                                float         frac,
+                                float* const* dst,
+                                size_t        offset,
+                                size_t        n)
+    {
+        const float* a = frames + pos * 2;
+        const float* b = a - 2;
+        float*       l = dst[0] + offset;
+        float*       r = dst[1] + offset;
+        size_t       i = 0;
+        for(; i + 4 <= n; i += 4)
+        {
+#if defined(DSY_INTERLEAVED_DELAY_SSE)
+            const __m128 f  = _mm_set1_ps(frac);
+            const __m128 a0 = _mm_loadu_ps(a + 2 * i);
+            const __m128 a1 = _mm_loadu_ps(a + 2 * i + 4);
+            const __m128 b0 = _mm_loadu_ps(b + 2 * i);
+            const __m128 b1 = _mm_loadu_ps(b + 2 * i + 4);
+            const __m128 o0 = _mm_add_ps(a0, _mm_mul_ps(_mm_sub_ps(b0, a0), f));
+            const __m128 o1 = _mm_add_ps(a1, _mm_mul_ps(_mm_sub_ps(b1, a1), f));
+            // [L0 R0 L1 R1] [L2 R2 L3 R3] -> [L0 L1 L2 L3] [R0 R1 R2 R3]
+            _mm_storeu_ps(l + i,
+                          _mm_shuffle_ps(o0, o1, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(r + i,
+                          _mm_shuffle_ps(o0, o1, _MM_SHUFFLE(3, 1, 3, 1)));
+#else
+            const float32x4_t   f  = vdupq_n_f32(frac);
+            const float32x4x2_t va = vld2q_f32(a + 2 * i);
+            const float32x4x2_t vb = vld2q_f32(b + 2 * i);
+            vst1q_f32(l + i,
+                      vmlaq_f32(va.val[0], vsubq_f32(vb.val[0], va.val[0]), f));
+            vst1q_f32(r + i,
+                      vmlaq_f32(va.val[1], vsubq_f32(vb.val[1], va.val[1]), f));
+#endif
+        }
+        for(; i < n; i++)
+        {
+            l[i] = a[2 * i] + (b[2 * i] - a[2 * i]) * frac;
+            r[i] = a[2 * i + 1] + (b[2 * i + 1] - a[2 * i + 1]) * frac;
+        }
+    }
+
+    static inline void Write(float*              frames,
+                             size_t              pos,
+                             const float* const* src,
+                             size_t              offset,
+                             size_t              n)
+    {
+        float*       out = frames + pos * 2;
+        const float* l   = src[0] + offset;
+        const float* r   = src[1] + offset;
+        size_t       i   = 0;
+        for(; i + 4 <= n; i += 4)
+        {
+#if defined(DSY_INTERLEAVED_DELAY_SSE)
+            const __m128 vl = _mm_loadu_ps(l + i);
+            const __m128 vr = _mm_loadu_ps(r + i);
+            _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(vl, vr));
+            _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(vl, vr));
+#else
+            float32x4x2_t v;
+            v.val[0] = vld1q_f32(l + i);
+            v.val[1] = vld1q_f32(r + i);
+            vst2q_f32(out + 2 * i, v);
+#endif
+        }
+        for(; i < n; i++)
+        {
+            out[2 * i]     = l[i];
+            out[2 * i + 1] = r[i];
+        }
+    }
+};
+#endif
+
+/* Fractional delay interpolators for InterleavedDelayLine::ReadBlock().
+    A read at delay d + frac (d integer) gathers kTaps samples x[0..kTaps-1],
+    x[j] being the sample written d - kNewer + j frames ago: x[kNewer] is the
+    sample at the integer delay, the following ones are older.
+    Interpolate() is called in order for every sample of a channel.
+*/
+/** Integer delay, the fractional part is dropped. */
+struct DelayInterpolateNone
+{
+    static constexpr size_t kTaps  = 1;
+    static constexpr size_t kNewer = 0;
+
+    template <typename T>
+    inline T Interpolate(const T* x, float, size_t)
+    {
+        return x[0];
+    }
+};
+
+/** Linear interpolation between the two nearest samples. */
+struct DelayInterpolateLinear
+{
+    static constexpr size_t kTaps  = 2;
+    static constexpr size_t kNewer = 0;
+
+    template <typename T>
+    inline T Interpolate(const T* x, float frac, size_t)
+    {
+        return x[0] + (x[1] - x[0]) * frac;
+    }
+};
+
+/** 4 point cubic Hermite interpolation (as DelayLine::ReadHermite()). */
+struct DelayInterpolateHermite
+{
+    static constexpr size_t kTaps  = 4;
+    static constexpr size_t kNewer = 1;
+
+    template <typename T>
+    inline T Interpolate(const T* x, float frac, size_t)
+    {
+        const T c     = (x[2] - x[0]) * 0.5f;
+        const T v     = x[1] - x[2];
+        const T w     = c + v;
+        const T a     = w + v + (x[3] - x[1]) * 0.5f;
+        const T b_neg = w + a;
+        return (((a * frac) - b_neg) * frac + c) * frac + x[1];
+    }
+};
+
+/** 4 point, third order Lagrange interpolation. */
+struct DelayInterpolateLagrange
+{
+    static constexpr size_t kTaps  = 4;
+    static constexpr size_t kNewer = 1;
+
+    template <typename T>
+    inline T Interpolate(const T* x, float frac, size_t)
+    {
+        const float fp1 = frac + 1.0f;
+        const float fm1 = frac - 1.0f;
+        const float fm2 = frac - 2.0f;
+        const float h0  = -frac * fm1 * fm2 * (1.0f / 6.0f);
+        const float h1  = fp1 * fm1 * fm2 * 0.5f;
+        const float h2  = -fp1 * frac * fm2 * 0.5f;
+        const float h3  = fp1 * frac * fm1 * (1.0f / 6.0f);
+        return x[0] * h0 + x[1] * h1 + x[2] * h2 + x[3] * h3;
+    }
+};
+
+/** First order allpass interpolation, flat magnitude response.
+    The fractional delay of the allpass is kept in [0.5, 1.5) (one sample
+    is taken from the integer part when frac < 0.5), so that its pole stays
+    away from the unit circle and transients die out.
+    It is recursive: each channel keeps its last output, so every read
+    stream (e.g. every tap) needs its own interpolator, reset with the line.
+*/
+template <typename T, size_t num_channels>
+class DelayInterpolateAllpass
+{
+  public:
+    static constexpr size_t kTaps  = 3;
+    static constexpr size_t kNewer = 1;
+
+    DelayInterpolateAllpass() { Reset(); }
+
+    /** clears the state of every channel. */
+    void Reset() { std::fill(prev_, prev_ + num_channels, T(0)); }
+
+    inline T Interpolate(const T* x, float frac, size_t ch)
+    {
+        const bool  low   = frac < 0.5f;
+        const float delta = low ? frac + 1.0f : frac;
+        const float eta   = (1.0f - delta) / (1.0f + delta);
+        const T     a     = low ? x[0] : x[1];
+        const T     b     = low ? x[1] : x[2];
+        const T     y     = a * eta + b - prev_[ch] * eta;
+        prev_[ch]         = y;
+        return y;
+    }
+
+  private:
+    T prev_[num_channels];
+};
+
+/** Delay line for num_channels channels sharing one write pointer.
+    Samples are stored as interleaved frames, so the channels of a frame
+    share a cache line and the stereo float case is processed with SSE/NEON.
+
+    The memory is supplied by the user, it must hold BufferSize(frames)
+    samples with frames a power of two. As in DelayLine, samples that were
+    not written since the last Reset() are read as zero.
+
+    declaration example: (stereo, 1 second of floats)
+
+    float buffer[InterleavedDelayLine<float, 2>::BufferSize(65536)];
+    InterleavedDelayLine<float, 2> del;
+    del.Init(buffer, 65536);
+*/
+template <typename T, size_t num_channels>
+class InterleavedDelayLine
+{
+  public:
+    InterleavedDelayLine() {}
+    ~InterleavedDelayLine() {}
+
+    /** Number of samples of the buffer needed for a line of frames frames
+        (one extra frame is kept as a copy of the last one).
+    */
+    static constexpr size_t BufferSize(size_t frames)
+    {
+        return (frames + 1) * num_channels;
+    }
+
+    /** initializes the delay line on a user supplied buffer.
+        \param buffer Memory for the delay line, BufferSize(frames) samples
+        \param frames Number of frames, must be a power of two
+    */
+    void Init(T* buffer, size_t frames)
+    {
+        assert(is_power2(static_cast<uint32_t>(frames)));
+        frames_   = buffer + num_channels;
+        capacity_ = frames;
+        Reset();
+    }
+
+    /** clears the line lazily (see DelayLine::Reset()), sets write ptr to 0.
+    */
+    void Reset()
+    {
+        written_   = 0;
+        write_ptr_ = 0;
+    }
+
+    /** Reads a block of n interpolated frames, one per frame of the block.
+        Same semantics as DelayLine::ReadBlock(), with one destination and
+        one delay array per channel. Every delay must be at least n.
+        \param dst num_channels destination buffers of n samples
+        \param delays num_channels arrays of n delay times in samples
+        \param n Number of frames to read
+    */
+    inline void
+    ReadBlock(T* const* dst, const float* const* delays, size_t n) const
+    {
+        if(written_ < capacity_)
+        {
+            ReadBlockAfterReset(dst, delays, 1, n);
+            return;
+        }
+        const size_t mask = capacity_ - 1;
+        for(size_t i = 0; i < n; i++)
+        {
+            InterleavedDelayKernel<T, num_channels>::Read(
+                frames_, mask, write_ptr_, dst, delays, i);
+        }
+    }
+
+    /** Reads a block of n interpolated frames at a constant delay per channel.
+        The read positions are contiguous, so each channel is read in at most
+        two spans without index wrapping (frame -1 is the older neighbour of
+        frame 0). When all the channels share the same delay, whole frames
+        are read at once.
+        \param dst num_channels destination buffers of n samples
+        \param delays num_channels delay times in samples, at least n
+        \param n Number of frames to read
+    */
+    inline void ReadBlock(T* const* dst, const float* delays, size_t n) const
+    {
+        if(written_ < capacity_)
+        {
+            const float* channel_delays[num_channels];
+            for(size_t ch = 0; ch < num_channels; ch++)
+            {
+                channel_delays[ch] = delays + ch;
+            }
+            ReadBlockAfterReset(dst, channel_delays, 0, n);
+            return;
+        }
+        bool linked = true;
+        for(size_t ch = 1; ch < num_channels; ch++)
+        {
+            linked = linked && delays[ch] == delays[0];
+        }
+        if(linked)
+        {
+            ReadSpans(dst, delays[0], num_channels, n);
+            return;
+        }
+        for(size_t ch = 0; ch < num_channels; ch++)
+        {
+            ReadSpans(dst, delays[ch], ch, n);
+        }
+    }
+
+    /** Reads a block of n frames with the interpolator interp, see the
+        DelayInterpolate* classes. Same semantics as the ReadBlock() above,
+        kernels that also read a newer sample (kNewer) need every delay to
+        be at least n + kNewer.
+        \param dst num_channels destination buffers of n samples
+        \param delays num_channels arrays of n delay times in samples
+        \param n Number of frames to read
+        \param interp Interpolator, it keeps its state across blocks
+    */
+    template <typename Interpolator>
+    inline void ReadBlock(T* const*           dst,
+                          const float* const* delays,
+                          size_t              n,
+                          Interpolator&       interp) const
+    {
+        const size_t mask = capacity_ - 1;
+        const bool   full = written_ >= capacity_;
+        T            x[Interpolator::kTaps];
+        for(size_t ch = 0; ch < num_channels; ch++)
+        {
+            for(size_t i = 0; i < n; i++)
+            {
+                const float   delay          = delays[ch][i];
+                const int32_t delay_integral = static_cast<int32_t>(delay);
+                const float   delay_fractional
+                    = delay - static_cast<float>(delay_integral);
+                // sample i is read i writes later, so it is i frames closer
+                const size_t d = static_cast<size_t>(delay_integral)
+                                 - Interpolator::kNewer - i;
+                if(full)
+                {
+                    for(size_t j = 0; j < Interpolator::kTaps; j++)
+                    {
+                        x[j] = frames_[((write_ptr_ - d - j) & mask)
+                                           * num_channels
+                                       + ch];
+                    }
+                }
+                else
+                {
+                    for(size_t j = 0; j < Interpolator::kTaps; j++)
+                    {
+                        x[j] = Tap(d + j, ch);
+                    }
+                }
+                dst[ch][i] = interp.Interpolate(x, delay_fractional, ch);
+            }
+        }
+    }
+
+    /** Writes a block of n frames and advances the write ptr by n.
+        \param src num_channels source buffers of n samples
+        \param n Number of frames to write
+    */
+    inline void WriteBlock(const T* const* src, size_t n)
+    {
+        size_t offset = 0;
+        while(n > 0)
+        {
+            const size_t span = std::min(n, capacity_ - write_ptr_);
+            InterleavedDelayKernel<T, num_channels>::Write(
+                frames_, write_ptr_, src, offset, span);
+            write_ptr_ = (write_ptr_ + span) & (capacity_ - 1);
+            written_   = std::min(written_ + span, capacity_);
+            offset += span;
+            n -= span;
+            if(write_ptr_ == 0)
+            {
+                // the last frame was written, refresh its copy at frame -1
+                std::copy(frames_ + (capacity_ - 1) * num_channels,
+                          frames_ + capacity_ * num_channels,
+                          frames_ - num_channels);
+            }
+        }
+    }
+
+  private:
+    /** sample of channel ch written delay frames ago,
+        or zero if it was not written since the last Reset().
+    */
+    inline T Tap(size_t delay, size_t ch) const
+    {
+        const size_t mask = capacity_ - 1;
+        const size_t age  = ((delay - 1) & mask) + 1;
+        return age <= written_
+                   ? frames_[((write_ptr_ - delay) & mask) * num_channels + ch]
+                   : T(0);
+    }
+
+    /** constant delay read of channel ch, or of every channel if ch is
+        num_channels, split in spans that do not wrap around the line.
+    */
+    inline void ReadSpans(T* const* dst, float delay, size_t ch, size_t n) const
+    {
+        const size_t  mask           = capacity_ - 1;
+        const int32_t delay_integral = static_cast<int32_t>(delay);
+        const float   delay_fractional
+            = delay - static_cast<float>(delay_integral);
+        size_t pos = (write_ptr_ - static_cast<size_t>(delay_integral)) & mask;
+        size_t offset = 0;
+        while(n > 0)
+        {
+            const size_t span = std::min(n, capacity_ - pos);
+            if(ch == num_channels)
+            {
+                InterleavedDelayKernel<T, num_channels>::ReadSpan(
+                    frames_, pos, delay_fractional, dst, offset, span);
+            }
+            else
+            {
+                const T* a   = frames_ + pos * num_channels + ch;
+                const T* b   = a - num_channels;
+                T*       out = dst[ch] + offset;
+                for(size_t i = 0; i < span; i++)
+                {
+                    const size_t k = i * num_channels;
+                    out[i]         = a[k] + (b[k] - a[k]) * delay_fractional;
+                }
+            }
+            offset += span;
+            n -= span;
+            pos = (pos + span) & mask;
+        }
+    }
+
+    /** ReadBlock() while the line is not completely written since Reset().
+        delays[ch] has n entries, or a single one if stride is 0.
+    */
+    inline void ReadBlockAfterReset(T* const*           dst,
+                                    const float* const* delays,
+                                    size_t              stride,
+                                    size_t              n) const
+    {
+        for(size_t ch = 0; ch < num_channels; ch++)
+        {
+            for(size_t i = 0; i < n; i++)
+            {
+                const float   delay          = delays[ch][i * stride];
+                const int32_t delay_integral = static_cast<int32_t>(delay);
+                const float   delay_fractional
+                    = delay - static_cast<float>(delay_integral);
+                const size_t d = static_cast<size_t>(delay_integral) - i;
+                const T      a = Tap(d, ch);
+                const T      b = Tap(d + 1, ch);
+                dst[ch][i]     = a + (b - a) * delay_fractional;
+            }
+        }
+    }
+
+    T*     frames_    = nullptr;
+    size_t capacity_  = 0;
+    size_t write_ptr_ = 0;
+    size_t written_   = 0;
+};
+} // namespace daisysp
+#endif
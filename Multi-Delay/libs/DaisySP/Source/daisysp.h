@@ -48,6 +48,7 @@
 #include "Filters/onepole.h"
 #include "Filters/svf.h"
 #include "Filters/fir.h"
+#include "Filters/interleaved_onepole.h"
 #include "Filters/soap.h"
 
 /** Noise Modules */
@@ -83,6 +84,7 @@
 #include "Utility/dcblock.h"
 #include "Utility/delayline.h"
 #include "Utility/dsp.h"
+#include "Utility/interleaved_delayline.h"
 #include "Utility/looper.h"
 #include "Utility/maytrig.h"
 #include "Utility/metro.h"
@@ -0,0 +1,114 @@
+// Classe BlockSmoother per lo smoothing lineare di un parametro a blocchi
+// Stessa rampa di juce::LinearSmoothedValue, ma i valori vengono generati un blocco alla volta:
+// ogni valore è calcolato dall'inizio della rampa (nessuna dipendenza tra campioni) come
+// valore di partenza + passo * indice, con juce::FloatVectorOperations (SIMD) su una tabella di indici
+// 1, 2, 3, ...: l'errore non si accumula campione dopo campione
+// La classe prevede un oggetto BlockSmoother con i seguenti parametri:
+//      - _current: Valore corrente
+//      - _target: Valore di destinazione
+//      - _start: Valore all'inizio della rampa
+//      - _step: Incremento per campione durante la rampa
+//      - _countdown: Campioni rimanenti alla fine della rampa (0 = valore costante)
+//      - _steps_to_target: Durata della rampa in campioni
+// Per impostare i parametri si utilizzano i metodi:
+//      - reset(double sample_rate, double ramp_length_in_seconds) per la durata della rampa
+//      - set_current_and_target_value(float value) per saltare subito a un valore
+//      - set_target_value(float value) per avviare una rampa verso un nuovo valore
+// Per ottenere i valori si utilizzano i metodi:
+//      - is_smoothing() che indica se la rampa è in corso (altrimenti il valore è costante)
+//      - get_remaining_samples() che restituisce i campioni rimanenti alla fine della rampa
+//      - render(float* values, int num_samples) che scrive i prossimi num_samples valori
+//      - skip(int num_samples) che avanza la rampa di num_samples valori senza scriverli
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "BlockSmoother.h"
+#include <array>
+
+#define RAMP_TABLE_SIZE 256                                     // Valori generati per ogni passata sulla tabella degli indici
+
+// Indici 1, 2, ..., RAMP_TABLE_SIZE, inizializzati al caricamento (nessuna inizializzazione nel thread audio)
+static const std::array<float, RAMP_TABLE_SIZE> ramp_indices = []
+{
+    std::array<float, RAMP_TABLE_SIZE> indices {};
+    for (int i = 0; i < RAMP_TABLE_SIZE; i++)
+        indices[static_cast<size_t>(i)] = static_cast<float>(i + 1);
+    return indices;
+}();
+
+BlockSmoother::BlockSmoother() : _current(0.0f), _target(0.0f), _start(0.0f), _step(0.0f), _countdown(0), _steps_to_target(0) {}
+
+void BlockSmoother::reset(double sample_rate, double ramp_length_in_seconds)
+{
+    _steps_to_target = static_cast<int>(std::floor(ramp_length_in_seconds * sample_rate));
+    set_current_and_target_value(_target);                      // Come LinearSmoothedValue::reset: salta alla destinazione
+}
+
+void BlockSmoother::set_current_and_target_value(float value)
+{
+    _current = _target = value;
+    _countdown = 0;
+}
+
+void BlockSmoother::set_target_value(float value)
+{
+    if (value == _target)
+        return;
+
+    if (_steps_to_target <= 0)
+    {
+        set_current_and_target_value(value);
+        return;
+    }
+
+    _target = value;
+    _start = _current;
+    _countdown = _steps_to_target;
+    _step = (_target - _current) / static_cast<float>(_countdown);
+}
+
+void BlockSmoother::render(float* values, int num_samples)
+{
+    if (_countdown <= 0)                                        // Valore costante
+    {
+        juce::FloatVectorOperations::fill(values, _target, num_samples);
+        return;
+    }
+
+    const int ramp = juce::jmin(num_samples, _countdown);
+    const int done = _steps_to_target - _countdown;             // Campioni della rampa già generati
+
+    // values[i] = _start + _step * (done + i + 1): passo * indice dalla tabella, più il valore di partenza del pezzo
+    for (int start = 0; start < ramp; start += RAMP_TABLE_SIZE)
+    {
+        const int count = juce::jmin(RAMP_TABLE_SIZE, ramp - start);
+        juce::FloatVectorOperations::multiply(values + start, ramp_indices.data(), _step, count);
+        juce::FloatVectorOperations::add(values + start, _start + _step * static_cast<float>(done + start), count);
+    }
+
+    _countdown -= ramp;
+    if (_countdown > 0)
+    {
+        _current = values[ramp - 1];
+        return;
+    }
+
+    // Fine della rampa: l'ultimo valore è esattamente la destinazione, poi il valore resta costante
+    _current = _target;
+    juce::FloatVectorOperations::fill(values + ramp - 1, _target, num_samples - ramp + 1);
+}
+
+void BlockSmoother::skip(int num_samples)
+{
+    if (_countdown <= 0)
+        return;
+
+    if (num_samples >= _countdown)
+    {
+        set_current_and_target_value(_target);                  // La rampa finisce entro num_samples
+        return;
+    }
+
+    _countdown -= num_samples;
+    _current = _start + _step * static_cast<float>(_steps_to_target - _countdown);
+}
@@ -0,0 +1,55 @@
+// Classe BlockSmoother per lo smoothing lineare di un parametro a blocchi
+// Stessa rampa di juce::LinearSmoothedValue, ma i valori vengono generati un blocco alla volta:
+// ogni valore è calcolato dall'inizio della rampa (nessuna dipendenza tra campioni) come
+// valore di partenza + passo * indice, con juce::FloatVectorOperations (SIMD) su una tabella di indici
+// 1, 2, 3, ...: l'errore non si accumula campione dopo campione
+// La classe prevede un oggetto BlockSmoother con i seguenti parametri:
+//      - _current: Valore corrente
+//      - _target: Valore di destinazione
+//      - _start: Valore all'inizio della rampa
+//      - _step: Incremento per campione durante la rampa
+//      - _countdown: Campioni rimanenti alla fine della rampa (0 = valore costante)
+//      - _steps_to_target: Durata della rampa in campioni
+// Per impostare i parametri si utilizzano i metodi:
+//      - reset(double sample_rate, double ramp_length_in_seconds) per la durata della rampa
+//      - set_current_and_target_value(float value) per saltare subito a un valore
+//      - set_target_value(float value) per avviare una rampa verso un nuovo valore
+// Per ottenere i valori si utilizzano i metodi:
+//      - is_smoothing() che indica se la rampa è in corso (altrimenti il valore è costante)
+//      - get_remaining_samples() che restituisce i campioni rimanenti alla fine della rampa
+//      - render(float* values, int num_samples) che scrive i prossimi num_samples valori
+//      - skip(int num_samples) che avanza la rampa di num_samples valori senza scriverli
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef __BLOCK_SMOOTHER_HPP__
+#define __BLOCK_SMOOTHER_HPP__
+
+#include <juce_audio_basics/juce_audio_basics.h>                // Libreria JUCE
+
+class BlockSmoother
+{
+private:
+    float _current;                                             // Valore corrente
+    float _target;                                              // Valore di destinazione
+    float _start;                                               // Valore all'inizio della rampa
+    float _step;                                                // Incremento per campione
+    int _countdown;                                             // Campioni rimanenti alla fine della rampa
+    int _steps_to_target;                                       // Durata della rampa in campioni
+
+public:
+    BlockSmoother();                                            // Costruttore dell'oggetto BlockSmoother
+
+    void reset(double sample_rate, double ramp_length_in_seconds);  // Metodo per impostare la durata della rampa
+    void set_current_and_target_value(float value);             // Metodo per saltare subito a un valore
+    void set_target_value(float value);                         // Metodo per avviare una rampa verso un nuovo valore
+    void render(float* values, int num_samples);                // Metodo per generare i prossimi num_samples valori
+    void skip(int num_samples);                                 // Metodo per avanzare la rampa senza generare i valori
+
+    float get_current_value() const { return _current; }        // Valore corrente
+    float get_target_value() const { return _target; }          // Valore di destinazione
+    bool is_smoothing() const { return _countdown > 0; }        // La rampa è in corso
+    int get_remaining_samples() const { return _countdown; }    // Campioni rimanenti alla fine della rampa
+};
+
+#endif // __BLOCK_SMOOTHER_HPP__
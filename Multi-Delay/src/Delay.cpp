@@ -1,16 +1,31 @@
 // Classe Delay per l'effetto delay
+// La classe è un template sul tipo dei campioni (Delay<float>, Delay<double>), le enumerazioni
+// delle modalità sono in DelayTypes e sono comuni alle due istanze.
 // La classe prevede un oggetto Delay con i seguenti parametri:
-//      - _delay: Buffer circolare per il delay
-//      - _read_i: Indice di lettura
-//      - _write_i_sx, _write_i_dx: Indici di scrittura per i canali sinistro e destro
+//      - _delay_line: Linea di ritardo stereo (frame sinistro/destro interleaved)
+//      - _buffer: Memoria della linea di ritardo, dimensionata in prepare
 //      - _sample_rate: Sample rate del progetto
 //      - _max_delay: Massimo ritardo in campioni
-//      - _dry_wet: Rapporto tra segnale diretto e segnale ritardato
-//      - _feedback: Feedback del segnale ritardato
-//      - _sync_enable: Abilita il delay sincronizzato tra i canali sinistro e destro
-//      - _mode_delay: Modalità del delay (feedback, pingpong)
-//      - _mode_pingpong: Modalità del delay pingpong (center, left, right)
-// Per impostare i parametri si utilizzano i metodi:
+//      - _parameters: Parametri in uso nel thread audio (ritardi di destinazione, dry/wet, feedback, sync,
+//        modalità, interpolazione, tap), copiati una volta per blocco da _shared_parameters
+//      - _shared_parameters: Snapshot dei parametri scritto dai metodi set_* (SeqLock, senza lock)
+//      - _smooth_delay_left, _smooth_delay_right: Ritardi con smoothing, generati a blocchi; a rampa finita
+//        il ritardo è costante e la linea viene letta con il percorso a ritardo costante
+//      - _silent_samples, _tail_peak, _idle: Rilevamento del silenzio; quando l'ingresso è silenzioso e la coda
+//        del feedback è scesa sotto -120 dBFS il delay va in idle e non elabora più la linea di ritardo
+//      - _tail_length_in_seconds: Ultima durata della coda calcolata, restituita se lo snapshot è occupato
+//      - _tap_*: Guadagni derivati e smoothing dei ritardi dei tap della modalità multitap,
+//        memorizzati come structure-of-arrays e letti tutti dalla stessa _delay_line
+//      - _fdn_lines: Linee della modalità fdn (feedback delay network), 4, 8 o 16 daisysp::DelayLine
+//        mescolate da una matrice ortogonale (Hadamard o Householder); le linee pari ricevono il canale sinistro,
+//        le dispari il destro, e i loro ritardi sono frazioni di delay sx/dx distribuite tra 0.5 e 1
+//      - _fdn_buffer, _fdn_pending, _fdn_*_lines: Memoria delle linee fdn, allocata da reserve_fdn_lines (fuori dal
+//        thread audio) solo quando la modalità viene attivata e consegnata al thread audio con uno scambio atomico;
+//        finché non arriva la modalità fdn viene elaborata come feedback
+//      - _low_cut_filter, _high_cut_filter: Filtri a un polo (passa-alto e passa-basso) nel feedback, applicati
+//        in place al segnale scritto nella linea, sinistro e destro insieme (ogni ripetizione è più scura)
+// Per impostare i parametri si utilizzano i metodi (da un solo thread alla volta, di norma il thread audio;
+// applicati all'inizio del prossimo process):
 //      - set_delay_sx_in_ms(float delay_in_ms) per il ritardo del canale sinistro
 //      - set_delay_dx_in_ms(float delay_in_ms) per il ritardo del canale destro
 //      - set_dry_wet(float value) per il rapporto tra segnale diretto e segnale ritardato
@@ -18,158 +33,1000 @@
 //      - enable_sync(bool enable) per abilitare il delay sincronizzato
 //      - set_delay_mode(int mode) per impostare la modalità del delay
 //      - set_pingpong_mode(int mode) per impostare la modalità del delay pingpong
+//      - set_interpolation(int interpolation) per impostare l'interpolazione delle letture
+//      - set_num_taps(int num_taps) per impostare il numero di tap attivi in modalità multitap
+//      - set_fdn_lines(int num_lines) per il numero di linee della modalità fdn (4, 8 o 16)
+//      - set_fdn_matrix(int matrix) per la matrice di feedback della modalità fdn (Hadamard, Householder)
+//      - set_low_cut(float frequency), set_high_cut(float frequency) per le frequenze di taglio (in Hz) dei filtri
+//        del feedback (LOW_CUT_OFF e HIGH_CUT_OFF li disattivano)
+//      - set_tap_delay_in_ms(int tap, float delay_in_ms), set_tap_gain(int tap, float gain),
+//        set_tap_pan(int tap, float pan), set_tap_feedback(int tap, float feedback) per i parametri di ogni tap
 // Per processare il segnale si utilizza il metodo:
-//      - prepare(double sample_rate, int max_num_samples) per inizializzare il delay
-//      - process(juce::AudioBuffer<float>& samples) per applicare l'effetto delay
+//      - prepare(double sample_rate, int max_num_samples, float max_delay_in_ms) per inizializzare il delay
+//      - process(juce::AudioBuffer<SampleType>& samples) per applicare l'effetto delay a un buffer stereo (un buffer
+//        mono viene elaborato come due canali uguali)
 //      - reset() per resettare il delay
+//      - reserve_fdn_lines(int num_lines) per allocare la memoria di num_lines linee fdn (fuori dal thread audio,
+//        un thread alla volta, non durante prepare)
+//      - get_fdn_lines_needed() che restituisce le linee fdn attese dal thread audio e non ancora allocate (0 se nessuna)
+//      - is_idle() che indica se il delay è in idle (ingresso e coda silenziosi)
+//      - get_tail_length_in_seconds() che restituisce la durata della coda del feedback (infinita con feedback 1),
+//        calcolata dallo snapshot dei parametri e quindi utilizzabile da qualsiasi thread
 /////////////////////////////////////////////////////////////////////////////////////////////
 
 
 #include "Delay.h"
+#include <limits>
 
 #define INITAL_SAMPLE_RATE 44100
+#define MAX_BLOCK_SIZE 64                                                       // Dimensione massima dei sotto-blocchi elaborati da process
+#define SILENCE_THRESHOLD 1.0e-6f                                               // -120 dBFS: sotto questa soglia ingresso e coda sono silenziosi
+#define MIN_DELAY 2                                                             // Ritardo minimo in campioni (Hermite, Lagrange e allpass leggono anche il campione a ritardo - 1)
+#define LOW_CUT_OFF 20.f                                                        // Taglio del passa-alto (Hz) che lo disattiva
+#define HIGH_CUT_OFF 20000.f                                                    // Taglio del passa-basso (Hz) che lo disattiva
+#define TAIL_READ_ATTEMPTS 16                                                   // Letture dello snapshot tentate da get_tail_length_in_seconds
 
-Delay::Delay() : 
+// Campioni più recenti del ritardo letti dall'interpolazione (Hermite, Lagrange e allpass leggono anche ritardo - 1)
+template <DelayTypes::Interpolation interpolation>
+static constexpr int newer_samples = (interpolation == DelayTypes::interpolation_none || interpolation == DelayTypes::interpolation_linear) ? 0 : 1;
+
+// Lettura di un sotto-blocco dalla linea di ritardo con l'interpolazione scelta a compile time
+template <DelayTypes::Interpolation interpolation, typename SampleType>
+static void read_delay_line(const daisysp::InterleavedDelayLine<SampleType, 2>& delay_line, SampleType* const* out, const float* const* delays,
+                            int num_samples, daisysp::DelayInterpolateAllpass<SampleType, 2>& allpass)
+{
+    const size_t n = static_cast<size_t>(num_samples);
+
+    if constexpr (interpolation == DelayTypes::interpolation_none)
+    {
+        daisysp::DelayInterpolateNone interpolator;
+        delay_line.ReadBlock(out, delays, n, interpolator);
+    }
+    else if constexpr (interpolation == DelayTypes::interpolation_linear)
+    {
+        delay_line.ReadBlock(out, delays, n);                                   // Kernel lineare SSE/NEON della linea
+    }
+    else if constexpr (interpolation == DelayTypes::interpolation_hermite)
+    {
+        daisysp::DelayInterpolateHermite interpolator;
+        delay_line.ReadBlock(out, delays, n, interpolator);
+    }
+    else if constexpr (interpolation == DelayTypes::interpolation_lagrange)
+    {
+        daisysp::DelayInterpolateLagrange interpolator;
+        delay_line.ReadBlock(out, delays, n, interpolator);
+    }
+    else
+    {
+        delay_line.ReadBlock(out, delays, n, allpass);                          // L'allpass è ricorsivo, lo stato resta tra i blocchi
+    }
+}
+
+template <typename SampleType>
+Delay<SampleType>::Delay() : 
     _sample_rate(INITAL_SAMPLE_RATE),
     _max_delay(INITAL_SAMPLE_RATE),
-    _dry_wet(0.15f),
-    _feedback(0.5f),
-    _sync_enable(false),
-    _mode_pingpong(Mode_clr::mode_center),
-    _mode_delay(Mode::mode_feedback)
+    _max_delay_in_ms(1000.f),
+    _silent_samples(0),
+    _tail_peak(0.f),
+    _idle(false),
+    _fdn_buffer_lines(0),
+    _fdn_capacity(0),
+    _fdn_pending_lines(0),
+    _fdn_reserved_lines(0),
+    _fdn_lines_needed(0),
+    _low_cut_enabled(false),
+    _high_cut_enabled(false),
+    _tail_length_in_seconds(0.)
 {
+    // Parametri iniziali; i tap hanno guadagno unitario, sono centrati e senza feedback
+    _shared_parameters.update([](Parameters& parameters)
+    {
+        parameters.delay_left = 0.0f;
+        parameters.delay_right = 0.0f;
+        parameters.dry_wet = 0.15f;
+        parameters.feedback = 0.5f;
+        parameters.sync_enable = false;
+        parameters.mode_pingpong = Mode_clr::mode_center;
+        parameters.mode_delay = Mode::mode_feedback;
+        parameters.interpolation = Interpolation::interpolation_linear;
+        parameters.num_taps = max_taps;
+        for (int tap = 0; tap < max_taps; tap++)
+        {
+            parameters.tap_delay[tap] = 0.0f;
+            parameters.tap_gain[tap] = 1.f;
+            parameters.tap_pan[tap] = 0.f;
+            parameters.tap_feedback[tap] = 0.f;
+        }
+        parameters.fdn_lines = 8;
+        parameters.fdn_matrix = FdnMatrix::matrix_hadamard;
+        parameters.low_cut = LOW_CUT_OFF;
+        parameters.high_cut = HIGH_CUT_OFF;
+        parameters.sample_rate = INITAL_SAMPLE_RATE;
+    });
+    _shared_parameters.try_read(_parameters, _parameters_version);              // Stesso thread dello scrittore: la lettura riesce sempre
+
     // Inizializziamo i smooth values
-    _smooth_delay_left.setCurrentAndTargetValue(0.0f);
-    _smooth_delay_right.setCurrentAndTargetValue(0.0f);
+    _smooth_delay_left.set_current_and_target_value(0.0f);
+    _smooth_delay_right.set_current_and_target_value(0.0f);
+    for (auto& smooth_tap_delay : _smooth_tap_delay)
+        smooth_tap_delay.set_current_and_target_value(0.0f);
+    update_tap_gains();
+
+    _low_cut_filter.Init();
+    _low_cut_filter.SetFilterMode(daisysp::OnePole::FILTER_MODE_HIGH_PASS);
+    _high_cut_filter.Init();
+    update_feedback_filters();
 }
 
-void Delay::reset()
+template <typename SampleType>
+void Delay<SampleType>::reset()
 {
-    if (_delay_left) _delay_left->Reset();
-    if (_delay_right) _delay_right->Reset();
+    // Reset in O(1): le linee non vengono riscritte, i campioni precedenti al reset si leggono come zero
+    _delay_line.Reset();
     _smooth_delay_left.reset(_sample_rate, 0.05);
     _smooth_delay_right.reset(_sample_rate, 0.05);
+    for (auto& smooth_tap_delay : _smooth_tap_delay)
+        smooth_tap_delay.reset(_sample_rate, 0.05);
+    reset_allpass();
+    reset_fdn();
+    _low_cut_filter.Reset();
+    _high_cut_filter.Reset();
+    _silent_samples = 0;
+    _tail_peak = 0.f;
+    _idle = false;
+}
+
+template <typename SampleType>
+void Delay<SampleType>::reset_allpass()
+{
+    _allpass.Reset();
+    for (auto& tap_allpass : _tap_allpass)
+        tap_allpass.Reset();
+}
+
+template <typename SampleType>
+void Delay<SampleType>::update_feedback_filters()
+{
+    // Un filtro al suo estremo non viene elaborato: a filtri spenti il feedback costa come senza filtri
+    _low_cut_enabled = _parameters.low_cut > LOW_CUT_OFF;
+    _high_cut_enabled = _parameters.high_cut < HIGH_CUT_OFF;
+    _low_cut_filter.SetFrequency(static_cast<float>(_parameters.low_cut / _sample_rate));
+    _high_cut_filter.SetFrequency(static_cast<float>(_parameters.high_cut / _sample_rate));
+}
+
+template <typename SampleType>
+void Delay<SampleType>::filter_feedback(SampleType* const* writes, int num_samples)
+{
+    // Sinistro e destro insieme, direttamente sui campioni da scrivere: nessuna copia aggiuntiva
+    if (_low_cut_enabled)
+        _low_cut_filter.ProcessBlock(writes, static_cast<size_t>(num_samples));
+    if (_high_cut_enabled)
+        _high_cut_filter.ProcessBlock(writes, static_cast<size_t>(num_samples));
 }
 
-void Delay::prepare(double sample_rate, int max_num_samples)
+template <typename SampleType>
+void Delay<SampleType>::reset_fdn()
 {
+    for (auto& fdn_line : _fdn_lines)
+        fdn_line.Reset();                                                       // O(1): i campioni non ancora scritti si leggono come zero
+}
+
+template <typename SampleType>
+void Delay<SampleType>::reserve_fdn_lines(int num_lines)
+{
+    if (num_lines <= 0)
+        return;
+
+    const int lines = juce::jlimit(4, max_fdn_lines, juce::nextPowerOfTwo(num_lines));
+    const juce::ScopedLock lock(_fdn_allocation_lock);
+
+    // Delay non ancora preparato, linee già allocate, oppure una consegna che il thread audio non ha ancora adottato
+    // (in quel caso _fdn_pending è sua: la richiesta si ripete con get_fdn_lines_needed)
+    if (_fdn_capacity == 0 || lines <= _fdn_reserved_lines.load(std::memory_order_relaxed)
+        || _fdn_pending_lines.load(std::memory_order_acquire) != 0)
+        return;
+
+    // La nuova memoria sostituisce quella restituita dal thread audio alla consegna precedente, liberata qui;
+    // è azzerata in questo thread, così il thread audio non la tocca per la prima volta
+    _fdn_pending = std::vector<SampleType>(_fdn_capacity * static_cast<size_t>(lines));
+    _fdn_reserved_lines.store(lines, std::memory_order_relaxed);
+    _fdn_pending_lines.store(lines, std::memory_order_release);
+}
+
+template <typename SampleType>
+void Delay<SampleType>::adopt_fdn_buffer()
+{
+    const int pending_lines = _fdn_pending_lines.load(std::memory_order_acquire);
+    if (pending_lines == 0)
+        return;
+
+    // Scambio dei puntatori: il thread audio non alloca e non libera, la memoria precedente torna all'allocatore
+    _fdn_buffer.swap(_fdn_pending);
+    for (int line = 0; line < pending_lines; line++)
+        _fdn_lines[line].Init(_fdn_buffer.data() + _fdn_capacity * static_cast<size_t>(line), _fdn_capacity);
+    _fdn_buffer_lines = pending_lines;
+    _fdn_lines_needed.store(0, std::memory_order_relaxed);
+    _fdn_pending_lines.store(0, std::memory_order_release);
+}
+
+template <typename SampleType>
+void Delay<SampleType>::prepare(double sample_rate, int max_num_samples, float max_delay_in_ms)
+{
+    juce::ignoreUnused(max_num_samples);
+
+    const int max_delay = juce::jmax(1, static_cast<int>(std::ceil(max_delay_in_ms * sample_rate / 1000.)));
+
+    // La linea di ritardo legge fino a _max_delay + 2 campioni indietro (interpolazione cubica),
+    // la capacità è arrotondata alla potenza di due successiva per il wrap con maschera
+    const size_t capacity = daisysp::get_next_power2(static_cast<uint32_t>(max_delay + 2));
+
+    // Se sample rate e capacità non sono cambiati (ad es. solo cambio di buffer size) le linee
+    // di ritardo vengono riutilizzate senza allocazioni
+    const size_t buffer_size = daisysp::InterleavedDelayLine<SampleType, 2>::BufferSize(capacity);
+    const bool same_config = sample_rate == _sample_rate && max_delay == _max_delay && _buffer.size() == buffer_size;
+
     _sample_rate = sample_rate;
-    _max_delay = juce::jmax((int)sample_rate, max_num_samples);
+    _max_delay_in_ms = max_delay_in_ms;
+    _max_delay = max_delay;
+
+    if (!same_config)
+    {
+        // resize alloca solo se serve più memoria di quella già riservata, Init azzera le linee
+        // in O(1): i campioni non ancora scritti vengono letti come zero senza toccare la memoria
+        _buffer.resize(buffer_size);
+        _delay_line.Init(_buffer.data(), capacity);
+
+        // Le linee della modalità fdn hanno la stessa capacità della linea stereo (il ritardo più lungo è delay sx/dx):
+        // la memoria della capacità precedente viene liberata, reserve_fdn_lines la rialloca se la modalità è attiva
+        const juce::ScopedLock lock(_fdn_allocation_lock);
+        _fdn_capacity = capacity;
+        _fdn_buffer = std::vector<SampleType>();
+        _fdn_pending = std::vector<SampleType>();
+        _fdn_buffer_lines = 0;
+        _fdn_pending_lines.store(0);
+        _fdn_reserved_lines.store(0);
+        _fdn_lines_needed.store(0);
+    }
+    _delay_line.Reset();                                                        // O(1): anche con le linee riutilizzate il contenuto precedente non viene più letto
 
-    _delay_left = std::make_unique<daisysp::DelayLine<float, 192000>>();
-    _delay_right = std::make_unique<daisysp::DelayLine<float, 192000>>();
-    
-    _delay_left->Init();
-    _delay_right->Init();
+    // I ritardi ripartono da zero: i prossimi set_delay_* avviano la rampa verso il nuovo ritardo.
+    // Il sample rate è pubblicato con lo snapshot: get_tail_length_in_seconds non legge _sample_rate
+    _shared_parameters.update([sample_rate](Parameters& parameters)
+    {
+        parameters.sample_rate = sample_rate;
+        parameters.delay_left = 0.0f;
+        parameters.delay_right = 0.0f;
+        for (auto& tap_delay : parameters.tap_delay)
+            tap_delay = 0.0f;
+    });
+    _shared_parameters.try_read(_parameters, _parameters_version);              // Stesso thread dello scrittore: la lettura riesce sempre
+    update_tap_gains();
+    update_feedback_filters();                                                  // I coefficienti dipendono dal sample rate
 
     // Inizializza lo smoothing
     _smooth_delay_left.reset(sample_rate, 0.05); // 50ms di smoothing time
     _smooth_delay_right.reset(sample_rate, 0.05);
-    _smooth_delay_left.setCurrentAndTargetValue(0.0f);
-    _smooth_delay_right.setCurrentAndTargetValue(0.0f);
+    _smooth_delay_left.set_current_and_target_value(0.0f);
+    _smooth_delay_right.set_current_and_target_value(0.0f);
+    for (auto& smooth_tap_delay : _smooth_tap_delay)
+    {
+        smooth_tap_delay.reset(sample_rate, 0.05);
+        smooth_tap_delay.set_current_and_target_value(0.0f);
+    }
+    reset_allpass();
+    reset_fdn();
+    _low_cut_filter.Reset();
+    _high_cut_filter.Reset();
+    _silent_samples = 0;
+    _tail_peak = 0.f;
+    _idle = false;
 }
 
-void Delay::process(juce::AudioBuffer<float>& buffer)
+template <typename SampleType>
+void Delay<SampleType>::process(juce::AudioBuffer<SampleType>& buffer)
 {
-    float* left_channel = buffer.getWritePointer(0);
-    float* right_channel = buffer.getWritePointer(1);
+    if (_buffer.empty() || buffer.getNumChannels() == 0)
+        return;
 
-    for (int i = 0; i < buffer.getNumSamples(); i++)
+    jassert(buffer.getNumChannels() == 2);                                      // Il delay è stereo, i canali oltre il secondo non sono elaborati
+    if (buffer.getNumChannels() < 2)
     {
-        float current_delay_left = _smooth_delay_left.getNextValue();
-        float current_delay_right = _sync_enable ? current_delay_left : _smooth_delay_right.getNextValue();
-        
-        if (_delay_left && _delay_right)
+        // Mono: il canale è elaborato come sinistro e destro uguali e l'uscita è la loro media, a sotto-blocchi
+        // con il destro in una copia locale (nessuna allocazione)
+        SampleType* mono_channel = buffer.getWritePointer(0);
+        SampleType right_copy[MAX_BLOCK_SIZE];
+        for (int start = 0; start < buffer.getNumSamples(); start += MAX_BLOCK_SIZE)
         {
-            _delay_left->SetDelay(current_delay_left);
-            _delay_right->SetDelay(current_delay_right);
+            const int count = juce::jmin(MAX_BLOCK_SIZE, buffer.getNumSamples() - start);
+            juce::FloatVectorOperations::copy(right_copy, mono_channel + start, count);
+            SampleType* channels[2] = { mono_channel + start, right_copy };
+            juce::AudioBuffer<SampleType> stereo(channels, 2, count);
+            process(stereo);
+            juce::FloatVectorOperations::add(mono_channel + start, right_copy, count);
+            juce::FloatVectorOperations::multiply(mono_channel + start, static_cast<SampleType>(0.5), count);
         }
+        return;
+    }
 
-        float out_left = left_channel[i];
-        float out_right = right_channel[i];
+    SampleType* left_channel = buffer.getWritePointer(0);
+    SampleType* right_channel = buffer.getWritePointer(1);
+    const int num_samples = buffer.getNumSamples();
 
-        float out_left_delay = _delay_left->Read();
-        float out_right_delay = _delay_right->Read();
+    update_parameters();                                                        // I parametri restano costanti per tutto il blocco
+    adopt_fdn_buffer();
 
-        left_channel[i] = out_left * (1.f - _dry_wet) + out_left_delay * _dry_wet;
-        right_channel[i] = out_right * (1.f - _dry_wet) + out_right_delay * _dry_wet;
+    // Rilevamento del silenzio: dopo tail_length_in_samples campioni di ingresso silenzioso la linea
+    // contiene solo campioni sotto la soglia, l'uscita è il solo segnale diretto
+    const float input_peak = static_cast<float>(juce::jmax(buffer.getMagnitude(0, 0, num_samples), buffer.getMagnitude(1, 0, num_samples)));
+    if (input_peak > SILENCE_THRESHOLD)
+    {
+        _silent_samples = 0;
+        _tail_peak = juce::jmax(_tail_peak, input_peak);
+        _idle = false;
+    }
+    else if (!_idle)
+    {
+        // Ritardo massimo tra posizione corrente e destinazione delle rampe in corso
+        float delay = 0.f;
+        if (_parameters.mode_delay == Mode::mode_multitap)
+        {
+            for (int tap = 0; tap < _parameters.num_taps; tap++)
+                delay = juce::jmax(delay, _smooth_tap_delay[tap].get_current_value(), _smooth_tap_delay[tap].get_target_value());
+        }
+        else
+        {
+            delay = juce::jmax(_smooth_delay_left.get_current_value(), _smooth_delay_left.get_target_value(),
+                               juce::jmax(_smooth_delay_right.get_current_value(), _smooth_delay_right.get_target_value()));
+        }
 
-        switch (_mode_delay)
+        if (static_cast<double>(_silent_samples) >= tail_length_in_samples(delay, loop_gain(_parameters), _tail_peak))
         {
-        case Mode::mode_feedback:
-            _delay_left->Write(out_left + out_left_delay * _feedback);
-            _delay_right->Write(out_right + out_right_delay * _feedback);
+            _idle = true;                                                       // La coda è finita prima dell'inizio di questo blocco
+            _tail_peak = 0.f;
+        }
+        else
+        {
+            _silent_samples += num_samples;
+        }
+    }
+
+    if (_idle)
+    {
+        // In idle la linea non viene letta né scritta, le rampe dei ritardi proseguono comunque
+        _smooth_delay_left.skip(num_samples);
+        _smooth_delay_right.skip(num_samples);
+        for (auto& smooth_tap_delay : _smooth_tap_delay)
+            smooth_tap_delay.skip(num_samples);
+
+        juce::FloatVectorOperations::multiply(left_channel, static_cast<SampleType>(1.f - _parameters.dry_wet), num_samples);
+        juce::FloatVectorOperations::multiply(right_channel, static_cast<SampleType>(1.f - _parameters.dry_wet), num_samples);
+        return;
+    }
+
+    // La combinazione di modalità e interpolazione viene scelta una sola volta per blocco: i kernel non contengono salti
+    switch (_parameters.interpolation)
+    {
+    case Interpolation::interpolation_none:     process_modes<Interpolation::interpolation_none>(left_channel, right_channel, num_samples); break;
+    case Interpolation::interpolation_linear:   process_modes<Interpolation::interpolation_linear>(left_channel, right_channel, num_samples); break;
+    case Interpolation::interpolation_hermite:  process_modes<Interpolation::interpolation_hermite>(left_channel, right_channel, num_samples); break;
+    case Interpolation::interpolation_lagrange: process_modes<Interpolation::interpolation_lagrange>(left_channel, right_channel, num_samples); break;
+    case Interpolation::interpolation_allpass:  process_modes<Interpolation::interpolation_allpass>(left_channel, right_channel, num_samples); break;
+    }
+}
+
+template <typename SampleType>
+template <DelayTypes::Interpolation interpolation>
+void Delay<SampleType>::process_modes(SampleType* left_channel, SampleType* right_channel, int num_samples)
+{
+    switch (_parameters.mode_delay)
+    {
+    case Mode::mode_feedback:
+        if (_parameters.sync_enable) process_block<Mode::mode_feedback, Mode_clr::mode_center, true, interpolation>(left_channel, right_channel, num_samples);
+        else              process_block<Mode::mode_feedback, Mode_clr::mode_center, false, interpolation>(left_channel, right_channel, num_samples);
+        break;
+
+    case Mode::mode_pingpong:
+        switch (_parameters.mode_pingpong)
+        {
+        case Mode_clr::mode_center:
+            if (_parameters.sync_enable) process_block<Mode::mode_pingpong, Mode_clr::mode_center, true, interpolation>(left_channel, right_channel, num_samples);
+            else              process_block<Mode::mode_pingpong, Mode_clr::mode_center, false, interpolation>(left_channel, right_channel, num_samples);
+            break;
+
+        case Mode_clr::mode_left:
+            if (_parameters.sync_enable) process_block<Mode::mode_pingpong, Mode_clr::mode_left, true, interpolation>(left_channel, right_channel, num_samples);
+            else              process_block<Mode::mode_pingpong, Mode_clr::mode_left, false, interpolation>(left_channel, right_channel, num_samples);
+            break;
+
+        case Mode_clr::mode_right:
+            if (_parameters.sync_enable) process_block<Mode::mode_pingpong, Mode_clr::mode_right, true, interpolation>(left_channel, right_channel, num_samples);
+            else              process_block<Mode::mode_pingpong, Mode_clr::mode_right, false, interpolation>(left_channel, right_channel, num_samples);
             break;
+        }
+        break;
+
+    case Mode::mode_multitap:
+        process_block_multitap<interpolation>(left_channel, right_channel, num_samples);
+        break;
+
+    case Mode::mode_fdn:                                                        // Le linee della rete usano sempre l'interpolazione lineare
+        if (_parameters.fdn_lines > _fdn_buffer_lines)
+        {
+            // Memoria delle linee non ancora consegnata: la richiesta passa a reserve_fdn_lines, intanto si usa il feedback
+            _fdn_lines_needed.store(_parameters.fdn_lines, std::memory_order_relaxed);
+            process_block<Mode::mode_feedback, Mode_clr::mode_center, false, interpolation>(left_channel, right_channel, num_samples);
+        }
+        else if (_parameters.fdn_matrix == FdnMatrix::matrix_hadamard) process_block_fdn<FdnMatrix::matrix_hadamard>(left_channel, right_channel, num_samples);
+        else                                                           process_block_fdn<FdnMatrix::matrix_householder>(left_channel, right_channel, num_samples);
+        break;
+    }
+}
+
+template <typename SampleType>
+template <DelayTypes::Mode mode, DelayTypes::Mode_clr pingpong_mode, bool sync, DelayTypes::Interpolation interpolation>
+void Delay<SampleType>::process_block(SampleType* left_channel, SampleType* right_channel, int num_samples)
+{
+    float delay_left[MAX_BLOCK_SIZE];                                           // Ritardo (in campioni) di ogni campione del sotto-blocco
+    float delay_right[MAX_BLOCK_SIZE];
+    SampleType out_left_delay[MAX_BLOCK_SIZE];                                  // Campioni letti dalle linee di ritardo
+    SampleType out_right_delay[MAX_BLOCK_SIZE];
+    SampleType write_left[MAX_BLOCK_SIZE];                                      // Campioni da scrivere nelle linee di ritardo
+    SampleType write_right[MAX_BLOCK_SIZE];
+
+    SampleType* out_delay[2] = { out_left_delay, out_right_delay };
+    const float* delays[2] = { delay_left, sync ? delay_left : delay_right };   // In sync entrambi i canali usano il ritardo sinistro
+    SampleType* writes[2] = { write_left, write_right };
+
+    // Copie locali dei parametri: restano nei registri per tutto il blocco
+    const float feedback = _parameters.feedback;
+    const float wet = _parameters.dry_wet;
+    const float dry = 1.f - _parameters.dry_wet;
+
+    for (int start = 0; start < num_samples;)
+    {
+        // Il sotto-blocco non può essere più lungo del ritardo minimo (meno i campioni più recenti letti
+        // dall'interpolazione), altrimenti si leggerebbero campioni non ancora scritti.
+        // Lo smoothing è lineare, quindi il minimo sta agli estremi della rampa.
+        float min_delay = juce::jmin(_smooth_delay_left.get_current_value(), _smooth_delay_left.get_target_value());
+        if constexpr (!sync)
+            min_delay = juce::jmin(min_delay, _smooth_delay_right.get_current_value(), _smooth_delay_right.get_target_value());
+
+        int block_size = juce::jmax(1, juce::jmin(num_samples - start, MAX_BLOCK_SIZE, static_cast<int>(min_delay) - newer_samples<interpolation>));
+
+        // Il sotto-blocco si ferma alla fine delle rampe in corso: è tutto in rampa oppure tutto a ritardo costante
+        bool constant_delay = true;
+        if (_smooth_delay_left.is_smoothing())
+        {
+            block_size = juce::jmin(block_size, _smooth_delay_left.get_remaining_samples());
+            constant_delay = false;
+        }
+        if constexpr (!sync)
+            if (_smooth_delay_right.is_smoothing())
+            {
+                block_size = juce::jmin(block_size, _smooth_delay_right.get_remaining_samples());
+                constant_delay = false;
+            }
+
+        if (interpolation == Interpolation::interpolation_linear && constant_delay)
+        {
+            // Caso più comune: nessuna rampa, letture contigue senza calcolo del ritardo per campione
+            const float delay[2] = { _smooth_delay_left.get_current_value(),
+                                     sync ? _smooth_delay_left.get_current_value() : _smooth_delay_right.get_current_value() };
+            _delay_line.ReadBlock(out_delay, delay, block_size);
+        }
+        else
+        {
+            _smooth_delay_left.render(delay_left, block_size);
+            if constexpr (!sync)
+                _smooth_delay_right.render(delay_right, block_size);
+            read_delay_line<interpolation>(_delay_line, out_delay, delays, block_size, _allpass);
+        }
+
+        SampleType* left = left_channel + start;
+        SampleType* right = right_channel + start;
+
+        for (int i = 0; i < block_size; i++)
+        {
+            const SampleType in_left = left[i];
+            const SampleType in_right = right[i];
+            const SampleType in_mono = (in_left + in_right) / 2;
 
-        case Mode::mode_pingpong:
-            switch (_mode_pingpong)
+            if constexpr (mode == Mode::mode_feedback)
             {
-            case Mode_clr::mode_center:
-                _delay_left->Write((out_left + out_right) / 2 + out_right_delay * _feedback);
-                _delay_right->Write((out_left + out_right) / 2 + out_left_delay * _feedback);
-                break;
-
-            case Mode_clr::mode_left:
-                _delay_left->Write((out_left + out_right) / 2 + out_right_delay * _feedback);
-                _delay_right->Write(out_left_delay * _feedback);
-                break;
-
-            case Mode_clr::mode_right:
-                _delay_left->Write(out_right_delay * _feedback);
-                _delay_right->Write((out_left + out_right) / 2 + out_left_delay * _feedback);
-                break;
+                write_left[i] = in_left + out_left_delay[i] * feedback;
+                write_right[i] = in_right + out_right_delay[i] * feedback;
             }
-            break;
+            else if constexpr (pingpong_mode == Mode_clr::mode_center)
+            {
+                write_left[i] = in_mono + out_right_delay[i] * feedback;
+                write_right[i] = in_mono + out_left_delay[i] * feedback;
+            }
+            else if constexpr (pingpong_mode == Mode_clr::mode_left)
+            {
+                write_left[i] = in_mono + out_right_delay[i] * feedback;
+                write_right[i] = out_left_delay[i] * feedback;
+            }
+            else
+            {
+                write_left[i] = out_right_delay[i] * feedback;
+                write_right[i] = in_mono + out_left_delay[i] * feedback;
+            }
+
+            left[i] = in_left * dry + out_left_delay[i] * wet;
+            right[i] = in_right * dry + out_right_delay[i] * wet;
+        }
+
+        filter_feedback(writes, block_size);
+        _delay_line.WriteBlock(writes, block_size);
+
+        start += block_size;
+    }
+}
+
+template <typename SampleType>
+template <DelayTypes::Interpolation interpolation>
+void Delay<SampleType>::process_block_multitap(SampleType* left_channel, SampleType* right_channel, int num_samples)
+{
+    float delay_tap[MAX_BLOCK_SIZE];                                            // Ritardo (in campioni) del tap corrente
+    SampleType out_left_tap[MAX_BLOCK_SIZE];                                    // Campioni letti dal tap corrente
+    SampleType out_right_tap[MAX_BLOCK_SIZE];
+    SampleType wet_left[MAX_BLOCK_SIZE];                                        // Somma dei tap (guadagno e pan applicati)
+    SampleType wet_right[MAX_BLOCK_SIZE];
+    SampleType write_left[MAX_BLOCK_SIZE];                                      // Ingresso + somma delle mandate di feedback
+    SampleType write_right[MAX_BLOCK_SIZE];
+
+    SampleType* out_tap[2] = { out_left_tap, out_right_tap };
+    const float* delays[2] = { delay_tap, delay_tap };                          // Un tap legge i due canali alla stessa posizione
+    SampleType* writes[2] = { write_left, write_right };
+
+    const int num_taps = _parameters.num_taps;
+    const float wet = _parameters.dry_wet;
+    const float dry = 1.f - _parameters.dry_wet;
+
+    for (int start = 0; start < num_samples;)
+    {
+        // Il sotto-blocco non può essere più lungo del ritardo minimo tra tutti i tap attivi
+        float min_delay = static_cast<float>(MAX_BLOCK_SIZE);
+        for (int tap = 0; tap < num_taps; tap++)
+            min_delay = juce::jmin(min_delay, _smooth_tap_delay[tap].get_current_value(), _smooth_tap_delay[tap].get_target_value());
+
+        int block_size = juce::jmax(1, juce::jmin(num_samples - start, MAX_BLOCK_SIZE, static_cast<int>(min_delay) - newer_samples<interpolation>));
+
+        // Il sotto-blocco si ferma alla fine delle rampe in corso (ogni tap è in rampa oppure costante)
+        for (int tap = 0; tap < num_taps; tap++)
+            if (_smooth_tap_delay[tap].is_smoothing())
+                block_size = juce::jmin(block_size, _smooth_tap_delay[tap].get_remaining_samples());
+
+        SampleType* left = left_channel + start;
+        SampleType* right = right_channel + start;
+
+        for (int i = 0; i < block_size; i++)
+        {
+            wet_left[i] = 0.f;
+            wet_right[i] = 0.f;
+            write_left[i] = left[i];
+            write_right[i] = right[i];
         }
+
+        // Tutti i tap leggono dalla stessa linea: ogni tap legge un tratto contiguo del buffer
+        // e si accumula sull'intero sotto-blocco, i cicli interni sono vettorizzabili
+        for (int tap = 0; tap < num_taps; tap++)
+        {
+            if (interpolation == Interpolation::interpolation_linear && !_smooth_tap_delay[tap].is_smoothing())
+            {
+                const float delay = _smooth_tap_delay[tap].get_current_value();
+                const float delay_both[2] = { delay, delay };
+                _delay_line.ReadBlock(out_tap, delay_both, block_size);
+            }
+            else
+            {
+                _smooth_tap_delay[tap].render(delay_tap, block_size);
+                read_delay_line<interpolation>(_delay_line, out_tap, delays, block_size, _tap_allpass[tap]);
+            }
+
+            const float gain_left = _tap_gain_left[tap];
+            const float gain_right = _tap_gain_right[tap];
+            const float feedback = _tap_feedback_gain[tap];
+
+            for (int i = 0; i < block_size; i++)
+            {
+                wet_left[i] += out_left_tap[i] * gain_left;
+                wet_right[i] += out_right_tap[i] * gain_right;
+                write_left[i] += out_left_tap[i] * feedback;
+                write_right[i] += out_right_tap[i] * feedback;
+            }
+        }
+
+        filter_feedback(writes, block_size);
+        _delay_line.WriteBlock(writes, block_size);
+
+        for (int i = 0; i < block_size; i++)
+        {
+            left[i] = left[i] * dry + wet_left[i] * wet;
+            right[i] = right[i] * dry + wet_right[i] * wet;
+        }
+
+        start += block_size;
     }
 }
 
-void Delay::set_delay_sx_in_ms(float delay_in_ms)
+template <typename SampleType>
+template <DelayTypes::FdnMatrix matrix>
+void Delay<SampleType>::process_block_fdn(SampleType* left_channel, SampleType* right_channel, int num_samples)
 {
-    if (_delay_left) {
-        float delay_in_samples = static_cast<float>(juce::jlimit(1, _max_delay, 
+    SampleType lines[max_fdn_lines][MAX_BLOCK_SIZE];                            // Uscite delle linee, poi (dopo la matrice) ingressi delle linee
+    SampleType wet_left[MAX_BLOCK_SIZE];                                        // Somma delle linee pari
+    SampleType wet_right[MAX_BLOCK_SIZE];                                       // Somma delle linee dispari
+    SampleType mix[MAX_BLOCK_SIZE];                                             // Somma di tutte le linee (Householder)
+    float delay_left[MAX_BLOCK_SIZE];                                           // Ritardi di base del sotto-blocco (in rampa)
+    float delay_right[MAX_BLOCK_SIZE];
+    float delay_line[MAX_BLOCK_SIZE];                                           // Ritardo della linea corrente (in rampa)
+
+    const int num_lines = _parameters.fdn_lines;
+
+    // Ritardi delle linee in progressione geometrica tra 1 e 0.5 volte il ritardo di base: rapporti irrazionali,
+    // le eco delle linee non coincidono e la coda è densa
+    float ratio[max_fdn_lines];
+    for (int line = 0; line < num_lines; line++)
+        ratio[line] = std::exp2(-static_cast<float>(line) / static_cast<float>(num_lines));
+
+    // Hadamard: la trasformata non normalizzata ha guadagno sqrt(N), la normalizzazione è nel feedback.
+    // Ogni canale entra in N/2 linee: l'uscita è scalata di sqrt(2/N) perché la prima eco abbia l'energia del delay semplice
+    const SampleType feedback = static_cast<SampleType>(matrix == FdnMatrix::matrix_hadamard ? _parameters.feedback / std::sqrt(static_cast<float>(num_lines))
+                                                                                             : _parameters.feedback);
+    const SampleType householder_gain = static_cast<SampleType>(2.f / static_cast<float>(num_lines));
+    const SampleType wet = static_cast<SampleType>(_parameters.dry_wet * std::sqrt(2.f / static_cast<float>(num_lines)));
+    const SampleType dry = static_cast<SampleType>(1.f - _parameters.dry_wet);
+
+    for (int start = 0; start < num_samples;)
+    {
+        // Il sotto-blocco non è più lungo della linea più corta (ritardo minimo per il rapporto più piccolo)
+        const float min_delay = juce::jmin(juce::jmin(_smooth_delay_left.get_current_value(), _smooth_delay_left.get_target_value()),
+                                           juce::jmin(_smooth_delay_right.get_current_value(), _smooth_delay_right.get_target_value()));
+        int block_size = juce::jmax(1, juce::jmin(num_samples - start, MAX_BLOCK_SIZE, static_cast<int>(min_delay * ratio[num_lines - 1])));
+
+        // Il sotto-blocco si ferma alla fine delle rampe in corso: è tutto in rampa oppure tutto a ritardo costante
+        bool constant_delay = true;
+        for (BlockSmoother* smooth_delay : { &_smooth_delay_left, &_smooth_delay_right })
+        {
+            if (smooth_delay->is_smoothing())
+            {
+                block_size = juce::jmin(block_size, smooth_delay->get_remaining_samples());
+                constant_delay = false;
+            }
+        }
+
+        if (constant_delay)
+        {
+            // Letture contigue a ritardo costante (kernel della DelayLine senza calcolo del ritardo per campione)
+            const float base[2] = { _smooth_delay_left.get_current_value(), _smooth_delay_right.get_current_value() };
+            for (int line = 0; line < num_lines; line++)
+                _fdn_lines[line].ReadBlock(lines[line], base[line & 1] * ratio[line], static_cast<size_t>(block_size));
+        }
+        else
+        {
+            _smooth_delay_left.render(delay_left, block_size);
+            _smooth_delay_right.render(delay_right, block_size);
+            for (int line = 0; line < num_lines; line++)
+            {
+                juce::FloatVectorOperations::multiply(delay_line, (line & 1) ? delay_right : delay_left, ratio[line], block_size);
+                _fdn_lines[line].ReadBlock(lines[line], delay_line, static_cast<size_t>(block_size));
+            }
+        }
+
+        // Uscita: linee pari a sinistra, dispari a destra
+        juce::FloatVectorOperations::copy(wet_left, lines[0], block_size);
+        juce::FloatVectorOperations::copy(wet_right, lines[1], block_size);
+        for (int line = 2; line < num_lines; line += 2)
+        {
+            juce::FloatVectorOperations::add(wet_left, lines[line], block_size);
+            juce::FloatVectorOperations::add(wet_right, lines[line + 1], block_size);
+        }
+
+        // Matrice di feedback applicata a righe intere di campioni: ogni passo è un ciclo SIMD sul sotto-blocco
+        if constexpr (matrix == FdnMatrix::matrix_hadamard)
+        {
+            // Trasformata veloce di Walsh-Hadamard: log2(N) passaggi di farfalle (a + b, a - b)
+            for (int half = 1; half < num_lines; half *= 2)
+            {
+                for (int first = 0; first < num_lines; first += 2 * half)
+                {
+                    for (int line = first; line < first + half; line++)
+                    {
+                        SampleType* a = lines[line];
+                        SampleType* b = lines[line + half];
+                        for (int i = 0; i < block_size; i++)
+                        {
+                            const SampleType sum = a[i] + b[i];
+                            b[i] = a[i] - b[i];
+                            a[i] = sum;
+                        }
+                    }
+                }
+            }
+        }
+        else
+        {
+            // Householder: ogni linea meno 2/N volte la somma di tutte le linee
+            juce::FloatVectorOperations::add(mix, wet_left, wet_right, block_size);
+            juce::FloatVectorOperations::multiply(mix, householder_gain, block_size);
+            for (int line = 0; line < num_lines; line++)
+                juce::FloatVectorOperations::subtract(lines[line], mix, block_size);
+        }
+
+        SampleType* left = left_channel + start;
+        SampleType* right = right_channel + start;
+
+        // Ingressi delle linee: feedback della matrice più il canale della linea
+        for (int line = 0; line < num_lines; line++)
+        {
+            SampleType* line_input = lines[line];
+            const SampleType* input = (line & 1) ? right : left;
+            for (int i = 0; i < block_size; i++)
+                line_input[i] = input[i] + line_input[i] * feedback;
+            _fdn_lines[line].WriteBlock(line_input, static_cast<size_t>(block_size));
+        }
+
+        for (int i = 0; i < block_size; i++)
+        {
+            left[i] = left[i] * dry + wet_left[i] * wet;
+            right[i] = right[i] * dry + wet_right[i] * wet;
+        }
+
+        start += block_size;
+    }
+}
+
+template <typename SampleType>
+void Delay<SampleType>::update_parameters()
+{
+    if (_shared_parameters.get_version() == _parameters_version)
+        return;
+
+    // Con una scrittura in corso (scrittore su un altro thread) restano i parametri precedenti, riletti al prossimo blocco
+    const Parameters previous = _parameters;
+    if (!_shared_parameters.try_read(_parameters, _parameters_version))
+        return;
+
+    // Un cambio di ritardo avvia la rampa dalla posizione corrente (set_target_value ignora i ritardi invariati)
+    _smooth_delay_left.set_target_value(_parameters.delay_left);
+    _smooth_delay_right.set_target_value(_parameters.delay_right);
+    for (int tap = 0; tap < max_taps; tap++)
+        _smooth_tap_delay[tap].set_target_value(_parameters.tap_delay[tap]);
+
+    if (_parameters.interpolation != previous.interpolation && _parameters.interpolation == Interpolation::interpolation_allpass)
+        reset_allpass();                                                        // Lo stato dell'allpass non è valido dopo un cambio
+
+    // Le linee della rete contengono la coda di quando la modalità era attiva (o di un'altra dimensione): si riparte da zero
+    if (_parameters.mode_delay == Mode::mode_fdn && (previous.mode_delay != Mode::mode_fdn || _parameters.fdn_lines != previous.fdn_lines))
+        reset_fdn();
+
+    update_tap_gains();
+
+    if (_parameters.low_cut != previous.low_cut || _parameters.high_cut != previous.high_cut)
+        update_feedback_filters();
+}
+
+template <typename SampleType>
+float Delay<SampleType>::loop_gain(const Parameters& parameters)
+{
+    // Guadagno del feedback per passaggio nella linea (per il multitap la somma delle mandate normalizzate dei tap attivi)
+    if (parameters.mode_delay != Mode::mode_multitap)
+        return parameters.feedback;
+
+    float feedback_sum = 0.f;
+    for (int tap = 0; tap < max_taps; tap++)
+        feedback_sum += parameters.tap_feedback[tap];
+
+    float feedback = 0.f;
+    for (int tap = 0; tap < parameters.num_taps; tap++)
+        feedback += parameters.tap_feedback[tap] / juce::jmax(1.f, feedback_sum);
+    return feedback;
+}
+
+template <typename SampleType>
+double Delay<SampleType>::tail_length_in_samples(float delay, float feedback, float peak)
+{
+    delay += 3.f;                                                               // Campioni letti dall'interpolazione oltre il ritardo
+
+    if (feedback >= 1.f)
+        return std::numeric_limits<double>::infinity();                         // Con feedback 1 la coda non si estingue
+
+    // Con il feedback il contenuto della linea si accumula fino a peak / (1 - feedback),
+    // poi ad ogni passaggio nella linea viene attenuato di feedback
+    const double level = static_cast<double>(peak) / (1. - feedback);
+    double passes = 1.;
+    if (feedback > 0.f && level > SILENCE_THRESHOLD)
+        passes = juce::jmax(1., std::ceil(std::log(SILENCE_THRESHOLD / level) / std::log(static_cast<double>(feedback))));
+
+    return static_cast<double>(delay) * passes;
+}
+
+template <typename SampleType>
+double Delay<SampleType>::get_tail_length_in_seconds() const
+{
+    // Dallo snapshot e non dallo stato del thread audio: può essere chiamato da qualsiasi thread.
+    // Il lettore non attende lo scrittore: se lo snapshot resta occupato si restituisce l'ultimo valore calcolato
+    Parameters parameters;
+    uint32_t version;
+    bool read = false;
+    for (int attempt = 0; attempt < TAIL_READ_ATTEMPTS && !read; attempt++)
+        read = _shared_parameters.try_read(parameters, version);
+    if (!read)
+        return _tail_length_in_seconds.load(std::memory_order_relaxed);
+
+    float delay = 0.f;
+    if (parameters.mode_delay == Mode::mode_multitap)
+    {
+        for (int tap = 0; tap < parameters.num_taps; tap++)
+            delay = juce::jmax(delay, parameters.tap_delay[tap]);
+    }
+    else
+    {
+        delay = juce::jmax(parameters.delay_left, parameters.delay_right);
+    }
+
+    const double tail_length_in_seconds = tail_length_in_samples(delay, loop_gain(parameters), 1.f) / parameters.sample_rate;
+    _tail_length_in_seconds.store(tail_length_in_seconds, std::memory_order_relaxed);
+    return tail_length_in_seconds;
+}
+
+template <typename SampleType>
+void Delay<SampleType>::update_tap_gains()
+{
+    // Pan lineare come nella classe Pan, le mandate di feedback sono normalizzate
+    // in modo che la loro somma non superi 1 (feedback stabile)
+    float feedback_sum = 0.f;
+    for (int tap = 0; tap < max_taps; tap++)
+    {
+        const float gain = _parameters.tap_gain[tap];
+        const float pan = _parameters.tap_pan[tap];
+        _tap_gain_left[tap] = gain * ((pan <= 0.0f) ? 1.0f : (1.0f - pan));
+        _tap_gain_right[tap] = gain * ((pan >= 0.0f) ? 1.0f : (1.0f + pan));
+        feedback_sum += _parameters.tap_feedback[tap];
+    }
+
+    const float feedback_scale = 1.f / juce::jmax(1.f, feedback_sum);
+    for (int tap = 0; tap < max_taps; tap++)
+        _tap_feedback_gain[tap] = _parameters.tap_feedback[tap] * feedback_scale;
+}
+
+template <typename SampleType>
+void Delay<SampleType>::set_delay_sx_in_ms(float delay_in_ms)
+{
+    if (!_buffer.empty()) {
+        float delay_in_samples = static_cast<float>(juce::jlimit(MIN_DELAY, _max_delay, 
             juce::roundToInt(delay_in_ms * _sample_rate / 1000.f)));
-        _smooth_delay_left.setTargetValue(delay_in_samples);
-        
-        if (_sync_enable)
-            _smooth_delay_right.setTargetValue(delay_in_samples);
+        _shared_parameters.update([delay_in_samples](Parameters& parameters)
+        {
+            parameters.delay_left = delay_in_samples;
+            if (parameters.sync_enable)
+                parameters.delay_right = delay_in_samples;
+        });
     }
 }
 
-void Delay::set_delay_dx_in_ms(float delay_in_ms)
+template <typename SampleType>
+void Delay<SampleType>::set_delay_dx_in_ms(float delay_in_ms)
 {
-    if (!_sync_enable && _delay_right) {
-        float delay_in_samples = static_cast<float>(juce::jlimit(1, _max_delay, 
+    if (!_buffer.empty()) {
+        float delay_in_samples = static_cast<float>(juce::jlimit(MIN_DELAY, _max_delay, 
             juce::roundToInt(delay_in_ms * _sample_rate / 1000.f)));
-        _smooth_delay_right.setTargetValue(delay_in_samples);
+        _shared_parameters.update([delay_in_samples](Parameters& parameters)
+        {
+            if (!parameters.sync_enable)
+                parameters.delay_right = delay_in_samples;
+        });
     }
 }
 
-void Delay::set_feedback(float feedback)
+template <typename SampleType>
+void Delay<SampleType>::set_feedback(float feedback)
+{
+    _shared_parameters.update([feedback](Parameters& parameters) { parameters.feedback = juce::jlimit(0.f, 1.f, feedback); });
+}
+
+template <typename SampleType>
+void Delay<SampleType>::set_dry_wet(float dry_wet)
+{
+    _shared_parameters.update([dry_wet](Parameters& parameters) { parameters.dry_wet = juce::jlimit(0.f, 1.f, dry_wet); });
+}
+
+template <typename SampleType>
+void Delay<SampleType>::enable_sync(bool enable)
+{
+    _shared_parameters.update([enable](Parameters& parameters)
+    {
+        parameters.sync_enable = enable;
+        if (enable)
+            parameters.delay_right = parameters.delay_left;                     // Il canale destro segue il sinistro
+    });
+}
+
+template <typename SampleType>
+void Delay<SampleType>::set_delay_mode(int mode)
 {
-    _feedback = juce::jlimit(0.f, 1.f, feedback);
+    _shared_parameters.update([mode](Parameters& parameters) { parameters.mode_delay = static_cast<Mode>(juce::jlimit(0, 3, mode)); });
 }
 
-void Delay::set_dry_wet(float dry_wet)
+template <typename SampleType>
+void Delay<SampleType>::set_pingpong_mode(int mode)
 {
-    _dry_wet = juce::jlimit(0.f, 1.f, dry_wet);
+    _shared_parameters.update([mode](Parameters& parameters) { parameters.mode_pingpong = static_cast<Mode_clr>(juce::jlimit(0, 2, mode)); });
 }
 
-void Delay::enable_sync(bool enable)
+template <typename SampleType>
+void Delay<SampleType>::set_interpolation(int interpolation)
 {
-    _sync_enable = enable;
-    if (enable)
+    _shared_parameters.update([interpolation](Parameters& parameters)
     {
-        _smooth_delay_right.setTargetValue(_smooth_delay_left.getCurrentValue());
+        parameters.interpolation = static_cast<Interpolation>(juce::jlimit(0, 4, interpolation));
+    });
+}
+
+template <typename SampleType>
+void Delay<SampleType>::set_num_taps(int num_taps)
+{
+    _shared_parameters.update([num_taps](Parameters& parameters) { parameters.num_taps = juce::jlimit(1, max_taps, num_taps); });
+}
+
+template <typename SampleType>
+void Delay<SampleType>::set_tap_delay_in_ms(int tap, float delay_in_ms)
+{
+    if (juce::isPositiveAndBelow(tap, max_taps) && !_buffer.empty()) {
+        float delay_in_samples = static_cast<float>(juce::jlimit(MIN_DELAY, _max_delay,
+            juce::roundToInt(delay_in_ms * _sample_rate / 1000.f)));
+        _shared_parameters.update([tap, delay_in_samples](Parameters& parameters) { parameters.tap_delay[tap] = delay_in_samples; });
     }
 }
 
-void Delay::set_delay_mode(int mode)
+template <typename SampleType>
+void Delay<SampleType>::set_tap_gain(int tap, float gain)
 {
-    _mode_delay = static_cast<Mode>(juce::jlimit(0, 1, mode));
+    if (juce::isPositiveAndBelow(tap, max_taps))
+        _shared_parameters.update([tap, gain](Parameters& parameters) { parameters.tap_gain[tap] = juce::jlimit(0.f, 1.f, gain); });
 }
 
-void Delay::set_pingpong_mode(int mode)
+template <typename SampleType>
+void Delay<SampleType>::set_tap_pan(int tap, float pan)
 {
-    _mode_pingpong = static_cast<Mode_clr>(juce::jlimit(0, 2, mode));
+    if (juce::isPositiveAndBelow(tap, max_taps))
+        _shared_parameters.update([tap, pan](Parameters& parameters) { parameters.tap_pan[tap] = juce::jlimit(-1.f, 1.f, pan); });
 }
+
+template <typename SampleType>
+void Delay<SampleType>::set_tap_feedback(int tap, float feedback)
+{
+    if (juce::isPositiveAndBelow(tap, max_taps))
+        _shared_parameters.update([tap, feedback](Parameters& parameters) { parameters.tap_feedback[tap] = juce::jlimit(0.f, 1.f, feedback); });
+}
+
+template <typename SampleType>
+void Delay<SampleType>::set_fdn_lines(int num_lines)
+{
+    // 4, 8 o 16 linee: la trasformata di Hadamard richiede una potenza di due
+    const int lines = juce::jlimit(4, max_fdn_lines, juce::nextPowerOfTwo(juce::jmax(1, num_lines)));
+    _shared_parameters.update([lines](Parameters& parameters) { parameters.fdn_lines = lines; });
+}
+
+template <typename SampleType>
+void Delay<SampleType>::set_fdn_matrix(int matrix)
+{
+    _shared_parameters.update([matrix](Parameters& parameters) { parameters.fdn_matrix = static_cast<FdnMatrix>(juce::jlimit(0, 1, matrix)); });
+}
+
+template <typename SampleType>
+void Delay<SampleType>::set_low_cut(float frequency)
+{
+    _shared_parameters.update([frequency](Parameters& parameters) { parameters.low_cut = juce::jlimit(LOW_CUT_OFF, HIGH_CUT_OFF, frequency); });
+}
+
+template <typename SampleType>
+void Delay<SampleType>::set_high_cut(float frequency)
+{
+    _shared_parameters.update([frequency](Parameters& parameters) { parameters.high_cut = juce::jlimit(LOW_CUT_OFF, HIGH_CUT_OFF, frequency); });
+}
+
+template class Delay<float>;
+template class Delay<double>;
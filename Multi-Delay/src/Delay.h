@@ -1,16 +1,31 @@
 // Classe Delay per l'effetto delay
+// La classe è un template sul tipo dei campioni (Delay<float>, Delay<double>), le enumerazioni
+// delle modalità sono in DelayTypes e sono comuni alle due istanze.
 // La classe prevede un oggetto Delay con i seguenti parametri:
-//      - _delay: Buffer circolare per il delay
-//      - _read_i: Indice di lettura
-//      - _write_i_sx, _write_i_dx: Indici di scrittura per i canali sinistro e destro
+//      - _delay_line: Linea di ritardo stereo (frame sinistro/destro interleaved)
+//      - _buffer: Memoria della linea di ritardo, dimensionata in prepare
 //      - _sample_rate: Sample rate del progetto
 //      - _max_delay: Massimo ritardo in campioni
-//      - _dry_wet: Rapporto tra segnale diretto e segnale ritardato
-//      - _feedback: Feedback del segnale ritardato
-//      - _sync_enable: Abilita il delay sincronizzato tra i canali sinistro e destro
-//      - _mode_delay: Modalità del delay (feedback, pingpong)
-//      - _mode_pingpong: Modalità del delay pingpong (center, left, right)
-// Per impostare i parametri si utilizzano i metodi:
+//      - _parameters: Parametri in uso nel thread audio (ritardi di destinazione, dry/wet, feedback, sync,
+//        modalità, interpolazione, tap), copiati una volta per blocco da _shared_parameters
+//      - _shared_parameters: Snapshot dei parametri scritto dai metodi set_* (SeqLock, senza lock)
+//      - _smooth_delay_left, _smooth_delay_right: Ritardi con smoothing, generati a blocchi; a rampa finita
+//        il ritardo è costante e la linea viene letta con il percorso a ritardo costante
+//      - _silent_samples, _tail_peak, _idle: Rilevamento del silenzio; quando l'ingresso è silenzioso e la coda
+//        del feedback è scesa sotto -120 dBFS il delay va in idle e non elabora più la linea di ritardo
+//      - _tail_length_in_seconds: Ultima durata della coda calcolata, restituita se lo snapshot è occupato
+//      - _tap_*: Guadagni derivati e smoothing dei ritardi dei tap della modalità multitap,
+//        memorizzati come structure-of-arrays e letti tutti dalla stessa _delay_line
+//      - _fdn_lines: Linee della modalità fdn (feedback delay network), 4, 8 o 16 daisysp::DelayLine
+//        mescolate da una matrice ortogonale (Hadamard o Householder); le linee pari ricevono il canale sinistro,
+//        le dispari il destro, e i loro ritardi sono frazioni di delay sx/dx distribuite tra 0.5 e 1
+//      - _fdn_buffer, _fdn_pending, _fdn_*_lines: Memoria delle linee fdn, allocata da reserve_fdn_lines (fuori dal
+//        thread audio) solo quando la modalità viene attivata e consegnata al thread audio con uno scambio atomico;
+//        finché non arriva la modalità fdn viene elaborata come feedback
+//      - _low_cut_filter, _high_cut_filter: Filtri a un polo (passa-alto e passa-basso) nel feedback, applicati
+//        in place al segnale scritto nella linea, sinistro e destro insieme (ogni ripetizione è più scura)
+// Per impostare i parametri si utilizzano i metodi (da un solo thread alla volta, di norma il thread audio;
+// applicati all'inizio del prossimo process):
 //      - set_delay_sx_in_ms(float delay_in_ms) per il ritardo del canale sinistro
 //      - set_delay_dx_in_ms(float delay_in_ms) per il ritardo del canale destro
 //      - set_dry_wet(float value) per il rapporto tra segnale diretto e segnale ritardato
@@ -18,10 +33,25 @@
 //      - enable_sync(bool enable) per abilitare il delay sincronizzato
 //      - set_delay_mode(int mode) per impostare la modalità del delay
 //      - set_pingpong_mode(int mode) per impostare la modalità del delay pingpong
+//      - set_interpolation(int interpolation) per impostare l'interpolazione delle letture
+//      - set_num_taps(int num_taps) per impostare il numero di tap attivi in modalità multitap
+//      - set_fdn_lines(int num_lines) per il numero di linee della modalità fdn (4, 8 o 16)
+//      - set_fdn_matrix(int matrix) per la matrice di feedback della modalità fdn (Hadamard, Householder)
+//      - set_low_cut(float frequency), set_high_cut(float frequency) per le frequenze di taglio (in Hz) dei filtri
+//        del feedback (LOW_CUT_OFF e HIGH_CUT_OFF li disattivano)
+//      - set_tap_delay_in_ms(int tap, float delay_in_ms), set_tap_gain(int tap, float gain),
+//        set_tap_pan(int tap, float pan), set_tap_feedback(int tap, float feedback) per i parametri di ogni tap
 // Per processare il segnale si utilizza il metodo:
-//      - prepare(double sample_rate, int max_num_samples) per inizializzare il delay
-//      - process(juce::AudioBuffer<float>& samples) per applicare l'effetto delay
+//      - prepare(double sample_rate, int max_num_samples, float max_delay_in_ms) per inizializzare il delay
+//      - process(juce::AudioBuffer<SampleType>& samples) per applicare l'effetto delay a un buffer stereo (un buffer
+//        mono viene elaborato come due canali uguali)
 //      - reset() per resettare il delay
+//      - reserve_fdn_lines(int num_lines) per allocare la memoria di num_lines linee fdn (fuori dal thread audio,
+//        un thread alla volta, non durante prepare)
+//      - get_fdn_lines_needed() che restituisce le linee fdn attese dal thread audio e non ancora allocate (0 se nessuna)
+//      - is_idle() che indica se il delay è in idle (ingresso e coda silenziosi)
+//      - get_tail_length_in_seconds() che restituisce la durata della coda del feedback (infinita con feedback 1),
+//        calcolata dallo snapshot dei parametri e quindi utilizzabile da qualsiasi thread
 /////////////////////////////////////////////////////////////////////////////////////////////
 
 
@@ -29,15 +59,17 @@
 #define __DELAY_HPP__
 
 #define _USE_MATH_DEFINES
+#include <atomic>
 #include <cmath>
 #include <juce_audio_basics/juce_audio_basics.h>
-#include <memory>
+#include <vector>
 #include "../libs/DaisySP/Source/daisysp.h"
+#include "BlockSmoother.h"
+#include "SeqLock.h"
 
 
-class Delay
+struct DelayTypes                                                               // Enumerazioni e costanti comuni a tutte le istanze di Delay
 {
-public:
     enum Mode_clr                                                               // Enumerazione per la modalità pingpong
     {
         mode_center = 0,                                                        // Centro
@@ -49,32 +81,136 @@ public:
     {
         mode_feedback = 0,                                                      // Feedback
         mode_pingpong = 1,                                                      // Pingpong
+        mode_multitap = 2,                                                      // Multitap
+        mode_fdn = 3,                                                           // Feedback delay network
+    };
+
+    enum FdnMatrix                                                              // Enumerazione per la matrice di feedback della modalità fdn
+    {
+        matrix_hadamard = 0,                                                    // Hadamard (trasformata di Walsh-Hadamard normalizzata)
+        matrix_householder = 1,                                                 // Householder (I - 2/N 11^T)
     };
 
+    enum Interpolation                                                          // Enumerazione per l'interpolazione delle letture
+    {
+        interpolation_none = 0,                                                 // Nessuna (ritardo intero)
+        interpolation_linear = 1,                                               // Lineare
+        interpolation_hermite = 2,                                              // Hermite cubica a 4 punti
+        interpolation_lagrange = 3,                                             // Lagrange del terzo ordine a 4 punti
+        interpolation_allpass = 4,                                              // Allpass del primo ordine
+    };
+
+    static constexpr int max_taps = 4;                                          // Numero massimo di tap in modalità multitap
+    static constexpr int max_fdn_lines = 16;                                    // Numero massimo di linee in modalità fdn
+
+    struct Parameters                                                           // Parametri del delay, pubblicati come snapshot
+    {
+        float delay_left;                                                       // Ritardo di destinazione (in campioni) del canale sinistro
+        float delay_right;                                                      // Ritardo di destinazione (in campioni) del canale destro
+        float dry_wet;                                                          // Dry/Wet
+        float feedback;                                                         // Feedback
+        bool sync_enable;                                                       // Delay sincronizzato tra i canali sinistro e destro
+        Mode_clr mode_pingpong;                                                 // Modalità del delay pingpong
+        Mode mode_delay;                                                        // Modalità del delay
+        Interpolation interpolation;                                            // Interpolazione delle letture
+        int num_taps;                                                           // Numero di tap attivi
+        float tap_delay[max_taps];                                              // Ritardo di destinazione (in campioni) di ogni tap
+        float tap_gain[max_taps];                                               // Guadagno di ogni tap
+        float tap_pan[max_taps];                                                // Pan di ogni tap (-1 sinistra, +1 destra)
+        float tap_feedback[max_taps];                                           // Mandata di feedback di ogni tap
+        int fdn_lines;                                                          // Linee della modalità fdn (4, 8 o 16)
+        FdnMatrix fdn_matrix;                                                   // Matrice di feedback della modalità fdn
+        float low_cut;                                                          // Frequenza di taglio (Hz) del passa-alto nel feedback
+        float high_cut;                                                         // Frequenza di taglio (Hz) del passa-basso nel feedback
+        double sample_rate;                                                     // Sample rate di prepare, per get_tail_length_in_seconds
+    };
+};
+
+template <typename SampleType>
+class Delay : public DelayTypes
+{
 private:
-    std::unique_ptr<daisysp::DelayLine<float, 192000>> _delay_left;
-    std::unique_ptr<daisysp::DelayLine<float, 192000>> _delay_right;
+    daisysp::InterleavedDelayLine<SampleType, 2> _delay_line;                   // Linea di ritardo stereo, un frame (sinistro, destro) per campione
+    std::vector<SampleType> _buffer;                                            // Memoria della linea di ritardo
 
     double _sample_rate;                                                        // Sample rate del progetto
 
     int _max_delay;                                                             // Massimo ritardo in campioni
-    float _dry_wet;                                                             // Dry/Wet
-    float _feedback;                                                            // Feedback
-    bool _sync_enable;                                                          // Abilita il delay sincronizzato tra i canali sinistro e destro
-    
-    Mode_clr _mode_pingpong;                                                    // Modalità del delay pingpong
-    Mode _mode_delay;                                                           // Modalità del delay
-
-    juce::LinearSmoothedValue<float> _smooth_delay_left;
-    juce::LinearSmoothedValue<float> _smooth_delay_right;
+    float _max_delay_in_ms;                                                     // Massimo ritardo in millisecondi
+    // Parametri: i metodi set_* aggiornano lo snapshot, process lo copia in _parameters una volta per blocco
+    SeqLock<Parameters> _shared_parameters;                                     // Snapshot scritto dai metodi set_*
+    Parameters _parameters;                                                     // Parametri in uso nel thread audio
+    uint32_t _parameters_version;                                               // Versione dello snapshot copiata in _parameters
+    daisysp::DelayInterpolateAllpass<SampleType, 2> _allpass;                   // Stato dell'interpolazione allpass (sinistro, destro)
+
+    BlockSmoother _smooth_delay_left;                                           // Ritardo (in campioni) del canale sinistro
+    BlockSmoother _smooth_delay_right;                                          // Ritardo (in campioni) del canale destro
+
+    // Rilevamento del silenzio
+    juce::int64 _silent_samples;                                                // Campioni consecutivi di ingresso silenzioso
+    float _tail_peak;                                                           // Picco dell'ingresso dall'ultima uscita dall'idle
+    bool _idle;                                                                 // Ingresso e coda silenziosi: process non elabora la linea
+
+    // Tap della modalità multitap, in forma structure-of-arrays
+    float _tap_gain_left[max_taps];                                             // Guadagno sinistro (guadagno * pan) di ogni tap
+    float _tap_gain_right[max_taps];                                            // Guadagno destro (guadagno * pan) di ogni tap
+    float _tap_feedback_gain[max_taps];                                         // Mandata di feedback normalizzata (somma <= 1)
+    BlockSmoother _smooth_tap_delay[max_taps];                                  // Ritardo (in campioni) di ogni tap
+    daisysp::DelayInterpolateAllpass<SampleType, 2> _tap_allpass[max_taps];     // Stato dell'interpolazione allpass di ogni tap
+
+    // Linee della modalità fdn: la memoria è allocata da reserve_fdn_lines solo per le linee richieste
+    daisysp::DelayLine<SampleType, 0> _fdn_lines[max_fdn_lines];                // Una linea mono per ogni ramo della rete
+    std::vector<SampleType> _fdn_buffer;                                        // Memoria delle linee in uso, una dopo l'altra
+    int _fdn_buffer_lines;                                                      // Linee con memoria in _fdn_buffer (thread audio)
+    size_t _fdn_capacity;                                                       // Campioni per linea, come la linea stereo
+    std::vector<SampleType> _fdn_pending;                                       // Memoria in consegna, o restituita dal thread audio
+    std::atomic<int> _fdn_pending_lines;                                        // > 0: _fdn_pending è pronta per il thread audio
+    std::atomic<int> _fdn_reserved_lines;                                       // Linee allocate o in consegna
+    std::atomic<int> _fdn_lines_needed;                                         // Linee attese dal thread audio (0 se nessuna)
+    juce::CriticalSection _fdn_allocation_lock;                                 // Serializza gli allocatori, mai preso dal thread audio
+
+    // Filtri del feedback (modalità feedback, pingpong e multitap)
+    daisysp::InterleavedOnePole<SampleType, 2> _low_cut_filter;                 // Passa-alto (sinistro, destro)
+    daisysp::InterleavedOnePole<SampleType, 2> _high_cut_filter;                // Passa-basso (sinistro, destro)
+    bool _low_cut_enabled;                                                      // Passa-alto attivo (taglio sopra LOW_CUT_OFF)
+    bool _high_cut_enabled;                                                     // Passa-basso attivo (taglio sotto HIGH_CUT_OFF)
+
+    mutable std::atomic<double> _tail_length_in_seconds;                        // Ultima coda calcolata da get_tail_length_in_seconds
+
+    void update_parameters();                                                   // Copia lo snapshot dei parametri se è cambiato
+    void update_tap_gains();                                                    // Ricalcola i guadagni derivati dei tap
+    void reset_allpass();                                                       // Azzera lo stato delle interpolazioni allpass
+    void reset_fdn();                                                           // Azzera le linee della modalità fdn
+    void adopt_fdn_buffer();                                                    // Adotta la memoria consegnata da reserve_fdn_lines
+    void update_feedback_filters();                                             // Coefficienti dei filtri del feedback
+    void filter_feedback(SampleType* const* writes, int num_samples);           // Filtra in place il sotto-blocco da scrivere nella linea
+    static float loop_gain(const Parameters& parameters);                       // Guadagno del feedback per passaggio nella linea
+    static double tail_length_in_samples(float delay, float feedback, float peak);  // Durata della coda per un ingresso di picco peak
+
+    template <Interpolation interpolation>
+    void process_modes(SampleType* left_channel, SampleType* right_channel, int num_samples);  // Sceglie il kernel per la modalità corrente
+
+    template <Interpolation interpolation>
+    void process_block_multitap(SampleType* left_channel, SampleType* right_channel, int num_samples); // Kernel della modalità multitap
+
+    template <FdnMatrix matrix>
+    void process_block_fdn(SampleType* left_channel, SampleType* right_channel, int num_samples);      // Kernel della modalità fdn
+
+    template <Mode mode, Mode_clr pingpong_mode, bool sync, Interpolation interpolation>
+    void process_block(SampleType* left_channel, SampleType* right_channel, int num_samples);  // Kernel specializzato per una combinazione di modalità
 
 public:
     Delay();                                                                    // Costruttore dell'oggetto Delay
 
 
-    void prepare(double sample_rate, int max_num_samples);                      // Metodo per inizializzare il delay
-    void process(juce::AudioBuffer<float>& samples);                            // Metodo per applicare l'effetto delay
+    void prepare(double sample_rate, int max_num_samples, float max_delay_in_ms);   // Metodo per inizializzare il delay
+    void process(juce::AudioBuffer<SampleType>& samples);                       // Metodo per applicare l'effetto delay
     void reset();                                                               // Metodo per resettare il delay
+    void reserve_fdn_lines(int num_lines);                                      // Alloca le linee della modalità fdn (fuori dal thread audio)
+    int get_fdn_lines_needed() const { return _fdn_lines_needed.load(std::memory_order_relaxed); }   // Linee fdn attese dal thread audio
+
+    bool is_idle() const { return _idle; }                                      // Ingresso e coda silenziosi
+    double get_tail_length_in_seconds() const;                                  // Durata della coda del feedback per un ingresso a 0 dBFS
 
     void set_delay_dx_in_ms(float delay_in_ms);                                 // Metodo per impostare il ritardo del canale destro
     void set_delay_sx_in_ms(float delay_in_ms);                                 // Metodo per impostare il ritardo del canale sinistro
@@ -84,6 +220,18 @@ public:
 
     void set_delay_mode(int mode);                                              // Metodo per impostare la modalità del delay
     void set_pingpong_mode(int mode);                                           // Metodo per impostare la modalità del delay pingpong
+    void set_interpolation(int interpolation);                                  // Metodo per impostare l'interpolazione delle letture
+
+    void set_num_taps(int num_taps);                                            // Metodo per impostare il numero di tap attivi
+    void set_tap_delay_in_ms(int tap, float delay_in_ms);                       // Metodo per impostare il ritardo di un tap
+    void set_tap_gain(int tap, float gain);                                     // Metodo per impostare il guadagno di un tap
+    void set_tap_pan(int tap, float pan);                                       // Metodo per impostare il pan di un tap
+    void set_tap_feedback(int tap, float feedback);                             // Metodo per impostare la mandata di feedback di un tap
+
+    void set_fdn_lines(int num_lines);                                          // Metodo per impostare il numero di linee della modalità fdn
+    void set_fdn_matrix(int matrix);                                            // Metodo per impostare la matrice della modalità fdn
+    void set_low_cut(float frequency);                                          // Metodo per impostare il taglio del passa-alto nel feedback
+    void set_high_cut(float frequency);                                         // Metodo per impostare il taglio del passa-basso nel feedback
 
 };
 
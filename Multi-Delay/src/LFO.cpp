@@ -4,21 +4,41 @@
 //      - _amount: Ampiezza della modulazione
 //      - _shape: Forma d'onda (sine, saw, square)
 //      - _phase: Fase (per determinare la posizione della forma d'onda)
+//      - _sample_rate: Sample rate usato da render
+//      - _phase_increment: Incremento della fase per campione (_rate / _sample_rate)
+//      - _rotation_cos, _rotation_sin: Rotazione per campione dell'oscillatore in quadratura (forma sinusoidale)
 // Per impostare i parametri si utilizzano i metodi:
 //      - set_rate(float rateHz) per la frequenza
 //      - set_shape(int shape) per la forma d'onda
 //      - set_amount(float amount) per l'ampiezza
-// Per ottenere il valore successivo della forma d'onda si utilizza il metodo:
+//      - get_amount() che restituisce l'ampiezza (0 = nessuna modulazione)
+//      - set_sample_rate(double sampleRate) per il sample rate usato da render
+// Per ottenere i valori della forma d'onda si utilizzano i metodi:
+//      - render(float* output, int numSamples) che scrive i prossimi numSamples valori in output (percorso a blocchi)
 //      - getNextValue(double sampleRate) che prende in input il sample rate del progetto e restituisce il valore successivo della forma d'onda
 /////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "LFO.h"
 
-LFO::LFO() : _amount(0.0f), _rate(1.0f), _shape(shape_sine), _phase(0.0f) {}                            // Costruttore dell'oggetto LFO con inizializzazione dei parametri
+#define INITIAL_SAMPLE_RATE 44100.0
+#define TRANSITION_WIDTH 0.1f                                                                           // Larghezza della transizione della forma d'onda square
+
+LFO::LFO() : _amount(0.0f), _rate(1.0f), _shape(shape_sine), _phase(0.0f), _sample_rate(INITIAL_SAMPLE_RATE)  // Costruttore dell'oggetto LFO con inizializzazione dei parametri
+{
+    update_increment();
+}
+
+void LFO::update_increment()                                                                            // Ricalcola incremento e rotazione dopo un cambio di frequenza o sample rate
+{
+    _phase_increment = _rate / _sample_rate;                                                            // Stesso incremento di getNextValue
+    _rotation_cos = std::cos(2.0 * juce::MathConstants<double>::pi * _phase_increment);
+    _rotation_sin = std::sin(2.0 * juce::MathConstants<double>::pi * _phase_increment);
+}
 
 void LFO::set_rate(float rateHz)                                                                        // Metodo per impostare la frequenza
 {
     _rate = juce::jlimit(0.1f, 5.0f, rateHz);                                                           // Limita la frequenza tra 0.1 e 5 Hz attraverso il metodo jlimit
+    update_increment();
 }
 
 void LFO::set_shape(int shape)                                                                          // Metodo per impostare la forma d'onda
@@ -31,6 +51,76 @@ void LFO::set_amount(float amount)
     _amount = juce::jlimit(0.0f, 1.0f, amount);                                                         // Limita l'ampiezza tra 0 e 1 attraverso il metodo jlimit
 }
 
+float LFO::get_amount() const                                                                           // Metodo per ottenere l'ampiezza
+{
+    return _amount;
+}
+
+void LFO::set_sample_rate(double sampleRate)                                                            // Metodo per impostare il sample rate usato da render
+{
+    if (sampleRate > 0.0)
+    {
+        _sample_rate = sampleRate;
+        update_increment();
+    }
+}
+
+void LFO::render(float* output, int numSamples)                                                         // Metodo per generare un blocco di valori della forma d'onda
+{
+    if (numSamples <= 0)
+        return;
+
+    const double phase = _phase;                                                                        // Copie locali: restano nei registri per tutto il blocco
+    const double increment = _phase_increment;
+    const float amount = _amount;
+    const float blockPhase = static_cast<float>(phase);                                                 // Fase e incremento in singola precisione all'interno del blocco
+    const float blockIncrement = static_cast<float>(increment);                                         // (la fase accumulata tra i blocchi resta in double)
+
+    switch (_shape)
+    {
+        case shape_sine:
+        {
+            // Oscillatore in quadratura: (seno, coseno) ruotano di 2*pi*increment ad ogni campione, senza std::sin per campione.
+            // Lo stato riparte dalla fase ad ogni blocco, quindi l'errore di arrotondamento non si accumula tra i blocchi
+            double sine = std::sin(2.0 * juce::MathConstants<double>::pi * phase);
+            double cosine = std::cos(2.0 * juce::MathConstants<double>::pi * phase);
+            const double rotationCos = _rotation_cos;
+            const double rotationSin = _rotation_sin;
+            for (int i = 0; i < numSamples; ++i)
+            {
+                output[i] = static_cast<float>(sine) * amount;
+                const double nextSine = sine * rotationCos + cosine * rotationSin;                      // sin(a + b) = sin(a)cos(b) + cos(a)sin(b)
+                cosine = cosine * rotationCos - sine * rotationSin;                                     // cos(a + b) = cos(a)cos(b) - sin(a)sin(b)
+                sine = nextSine;
+            }
+            break;
+        }
+        case shape_saw:                                                                                 // Stesse forme di getNextValue, i tratti sono scelti senza salti
+            for (int i = 0; i < numSamples; ++i)                                                        // (troncamento a intero) e i cicli vengono vettorizzati
+            {
+                float p = blockPhase + static_cast<float>(i) * blockIncrement;                          // Fase del campione, riportata in [0, 1)
+                float t = p - static_cast<float>(static_cast<int>(p));
+                float secondHalf = static_cast<float>(static_cast<int>(t + 0.5f));                      // 0 fino a 0.5, poi 1
+                output[i] = (2.0f * t - 2.0f * secondHalf) * amount;                                    // 2t fino a 0.5, poi -2(1-t) = 2t - 2
+            }
+            break;
+        case shape_square:
+            for (int i = 0; i < numSamples; ++i)
+            {
+                float p = blockPhase + static_cast<float>(i) * blockIncrement;
+                float t = p - static_cast<float>(static_cast<int>(p));
+                float falling = juce::jmax(-1.0f, juce::jmin(1.0f, 1.0f - (t - (0.5f - TRANSITION_WIDTH)) / TRANSITION_WIDTH));   // 1, discesa attorno a 0.5, -1
+                float rising = -1.0f + (t - (1.0f - TRANSITION_WIDTH)) / TRANSITION_WIDTH;              // Salita prima della fine del periodo
+                float lastStep = static_cast<float>(static_cast<int>(t + TRANSITION_WIDTH));            // 1 nell'ultimo tratto (t >= 1 - TRANSITION_WIDTH)
+                output[i] = (falling + lastStep * (rising - falling)) * amount;
+            }
+            break;
+    }
+
+    _phase = phase + numSamples * increment;                                                            // Avanza la fase di numSamples campioni
+    _phase -= std::floor(_phase);
+}
+
 float LFO::getNextValue(double sampleRate)                                                              // Metodo per ottenere il valore successivo della forma d'onda
 {
     float value = 0.0f;                                                                                 // Inizializza il valore a 0
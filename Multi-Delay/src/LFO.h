@@ -4,11 +4,17 @@
 //      - _amount: Ampiezza della modulazione
 //      - _shape: Forma d'onda (sine, saw, square)
 //      - _phase: Fase (per determinare la posizione della forma d'onda)
+//      - _sample_rate: Sample rate usato da render
+//      - _phase_increment: Incremento della fase per campione (_rate / _sample_rate)
+//      - _rotation_cos, _rotation_sin: Rotazione per campione dell'oscillatore in quadratura (forma sinusoidale)
 // Per impostare i parametri si utilizzano i metodi:
 //      - set_rate(float rateHz) per la frequenza
 //      - set_shape(int shape) per la forma d'onda
 //      - set_amount(float amount) per l'ampiezza
-// Per ottenere il valore successivo della forma d'onda si utilizza il metodo:
+//      - get_amount() che restituisce l'ampiezza (0 = nessuna modulazione)
+//      - set_sample_rate(double sampleRate) per il sample rate usato da render
+// Per ottenere i valori della forma d'onda si utilizzano i metodi:
+//      - render(float* output, int numSamples) che scrive i prossimi numSamples valori in output (percorso a blocchi)
 //      - getNextValue(double sampleRate) che prende in input il sample rate del progetto e restituisce il valore successivo della forma d'onda
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -33,6 +39,12 @@ private:
     float _amount;                                  // Ampiezza della modulazione
     double _phase;                                  // Fase
     Shape _shape;                                   // Forma d'onda
+    double _sample_rate;                            // Sample rate usato da render
+    double _phase_increment;                        // Incremento della fase per campione
+    double _rotation_cos;                           // Coseno della rotazione per campione
+    double _rotation_sin;                           // Seno della rotazione per campione
+
+    void update_increment();                        // Ricalcola incremento e rotazione dopo un cambio di frequenza o sample rate
 
 
 public:
@@ -41,6 +53,9 @@ public:
     void set_rate(float rateHz);                    // Metodo per impostare la frequenza
     void set_shape(int shape);                      // Metodo per impostare la forma d'onda
     void set_amount(float amount);                  // Metodo per impostare l'ampiezza
+    float get_amount() const;                       // Metodo per ottenere l'ampiezza
+    void set_sample_rate(double sampleRate);        // Metodo per impostare il sample rate usato da render
+    void render(float* output, int numSamples);     // Metodo per generare un blocco di valori della forma d'onda
     float getNextValue(double sampleRate);          // Metodo per ottenere il valore successivo della forma d'onda
 };
 
@@ -0,0 +1,416 @@
+// Classe MultiChannelDelay per l'effetto delay su N canali (surround, ambisonico)
+// La classe è un template sul tipo dei campioni (MultiChannelDelay<float>, MultiChannelDelay<double>).
+// Ogni canale ha la sua linea di ritardo (daisysp::DelayLine su un blocco di _capacity campioni per canale);
+// l'ingresso di ogni linea è una combinazione dei canali d'ingresso (matrice di routing) e delle uscite
+// ritardate di tutte le linee (matrice di feedback):
+//      linea[c] = somma_j routing[c][j] * ingresso[j] + somma_j feedback[c][j] * ritardato[j]
+//      uscita[c] = (1 - dry_wet) * ingresso[c] + dry_wet * ritardato[c]
+// Come in Delay, l'ingresso di ogni linea passa per i filtri del feedback (passa-alto e passa-basso a un polo).
+// I canali che le due matrici non collegano tra loro formano gruppi indipendenti, elaborati uno dopo l'altro
+// dal thread audio (nessun thread ausiliario: nessun lock e nessuna attesa nel processBlock). L'elaborazione
+// parallela dei gruppi è fuori dagli obiettivi della classe: richiederebbe thread di lavoro in tempo reale
+// sincronizzati dentro il processBlock, per un costo misurato dell'ordine dell'1% di un core.
+// All'interno di un gruppo il lavoro è a blocchi: letture, mix delle matrici (FloatVectorOperations, SIMD)
+// e scritture operano su sotto-blocchi più corti del ritardo minimo del gruppo.
+// La classe prevede un oggetto MultiChannelDelay con i seguenti parametri:
+//      - _buffer: Memoria delle linee di ritardo, dimensionata in prepare e riutilizzata se la configurazione non cambia
+//      - _lines: Linee di ritardo dei canali (reset in O(1))
+//      - _capacity: Campioni per linea (potenza di 2)
+//      - _num_channels: Numero di canali elaborati
+//      - _sample_rate: Sample rate del progetto
+//      - _max_delay: Massimo ritardo in campioni
+//      - _parameters: Parametri in uso nel thread audio (ritardi, matrici, dry/wet, canali e sample rate), copiati una volta per blocco
+//        da _shared_parameters
+//      - _shared_parameters: Snapshot dei parametri scritto dai metodi set_* (SeqLock, senza lock)
+//      - _smooth_delay: Ritardi con smoothing, uno per canale
+//      - _low_cut_filter, _high_cut_filter, _low_cut_enabled, _high_cut_enabled: Filtri del feedback, uno per linea;
+//        un filtro al suo estremo non viene elaborato
+//      - _tail_length_in_seconds: Ultima durata della coda calcolata, restituita se lo snapshot è occupato
+//      - _group_channels, _group_start, _num_groups: Canali ordinati per gruppo indipendente
+//      - _delays, _delayed, _line_input: Memoria di lavoro per canale di un sotto-blocco
+// Per impostare i parametri si utilizzano i metodi (da un solo thread alla volta, di norma il thread audio;
+// applicati all'inizio del prossimo process):
+//      - set_delays_in_ms(const float* delays_in_ms) per i ritardi dei canali (num_channels valori)
+//      - set_routing_matrix(const float* matrix) per la matrice di routing (num_channels x num_channels, per righe)
+//      - set_feedback_matrix(const float* matrix) per la matrice di feedback (num_channels x num_channels, per righe)
+//      - set_dry_wet(float dry_wet) per il rapporto tra segnale diretto e segnale ritardato
+//      - set_low_cut(float frequency), set_high_cut(float frequency) per le frequenze di taglio (in Hz) dei filtri
+//        del feedback, come in Delay (LOW_CUT_OFF e HIGH_CUT_OFF li disattivano)
+// Per processare il segnale si utilizzano i metodi:
+//      - prepare(double sample_rate, int num_channels, float max_delay_in_ms) per inizializzare il delay
+//      - process(juce::AudioBuffer<SampleType>& buffer) per applicare l'effetto ai primi num_channels canali
+//      - reset() per resettare il delay
+//      - get_num_channels() che restituisce il numero di canali preparati
+//      - get_tail_length_in_seconds() che restituisce la durata della coda del feedback (infinita se la matrice
+//        di feedback non attenua), calcolata dallo snapshot dei parametri
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "MultiChannelDelay.h"
+
+#define INITAL_SAMPLE_RATE 44100
+#define MIN_DELAY 2                                                             // Ritardo minimo in campioni (l'interpolazione legge anche il campione a ritardo + 1)
+#define SILENCE_THRESHOLD 1.0e-6                                                // -120 dBFS: fine della coda
+#define TAIL_READ_ATTEMPTS 16                                                   // Letture dello snapshot tentate da get_tail_length_in_seconds
+#define LOW_CUT_OFF 20.f                                                        // Taglio del passa-alto (Hz) che lo disattiva, come in Delay
+#define HIGH_CUT_OFF 20000.f                                                    // Taglio del passa-basso (Hz) che lo disattiva, come in Delay
+
+
+template <typename SampleType>
+MultiChannelDelay<SampleType>::MultiChannelDelay() :
+    _capacity(0),
+    _num_channels(0),
+    _sample_rate(INITAL_SAMPLE_RATE),
+    _max_delay(INITAL_SAMPLE_RATE),
+    _low_cut_enabled(false),
+    _high_cut_enabled(false),
+    _num_groups(0),
+    _tail_length_in_seconds(0.)
+{
+    // Parametri iniziali: ogni canale scrive nella propria linea con feedback 0.5, come Delay
+    _shared_parameters.update([](Parameters& parameters)
+    {
+        for (int c = 0; c < max_channels; c++)
+        {
+            parameters.delay[c] = static_cast<float>(MIN_DELAY);
+            for (int j = 0; j < max_channels; j++)
+            {
+                parameters.routing[c][j] = (c == j) ? 1.0f : 0.0f;
+                parameters.feedback[c][j] = (c == j) ? 0.5f : 0.0f;
+            }
+        }
+        parameters.dry_wet = 0.15f;
+        parameters.low_cut = LOW_CUT_OFF;
+        parameters.high_cut = HIGH_CUT_OFF;
+        parameters.num_channels = 0;
+        parameters.sample_rate = INITAL_SAMPLE_RATE;
+    });
+    _shared_parameters.try_read(_parameters, _parameters_version);              // Stesso thread dello scrittore: la lettura riesce sempre
+
+    for (int c = 0; c < max_channels; c++)
+    {
+        _low_cut_filter[c].Init();
+        _low_cut_filter[c].SetFilterMode(daisysp::OnePole::FILTER_MODE_HIGH_PASS);
+        _high_cut_filter[c].Init();
+    }
+    update_feedback_filters();
+}
+
+template <typename SampleType>
+void MultiChannelDelay<SampleType>::prepare(double sample_rate, int num_channels, float max_delay_in_ms)
+{
+    const int channels = juce::jlimit(0, static_cast<int>(max_channels), num_channels);
+    const int max_delay = static_cast<int>(std::ceil(max_delay_in_ms * sample_rate / 1000.));
+
+    // Ogni linea contiene il ritardo massimo, il campione letto dall'interpolazione e un sotto-blocco
+    const int capacity = juce::nextPowerOfTwo(max_delay + max_block_size + MIN_DELAY);
+
+    // Se sample rate, ritardo massimo e canali non sono cambiati (ad es. solo cambio di buffer size) le linee
+    // vengono riutilizzate senza allocazioni, come in Delay
+    const size_t buffer_size = static_cast<size_t>(capacity) * static_cast<size_t>(channels);
+    const bool same_config = sample_rate == _sample_rate && max_delay == _max_delay && channels == _num_channels
+                          && _buffer.size() == buffer_size;
+
+    _sample_rate = sample_rate;
+    _num_channels = channels;
+    _max_delay = max_delay;
+    _capacity = capacity;
+
+    if (!same_config)
+    {
+        // resize alloca solo se serve più memoria di quella già riservata, Init azzera le linee in O(1)
+        _buffer.resize(buffer_size);
+        for (int c = 0; c < _num_channels; c++)
+            _lines[c].Init(_buffer.data() + static_cast<size_t>(_capacity) * static_cast<size_t>(c), static_cast<size_t>(_capacity));
+    }
+    for (int c = 0; c < _num_channels; c++)
+        _lines[c].Reset();                                                      // O(1): anche con le linee riutilizzate il contenuto precedente non viene più letto
+
+    // I ritardi ripartono dal minimo: i prossimi set_delays_in_ms avviano la rampa verso il nuovo ritardo.
+    // Canali e sample rate sono pubblicati con lo snapshot: get_tail_length_in_seconds non legge i membri
+    _shared_parameters.update([channels, sample_rate](Parameters& parameters)
+    {
+        parameters.num_channels = channels;
+        parameters.sample_rate = sample_rate;
+        for (auto& delay : parameters.delay)
+            delay = static_cast<float>(MIN_DELAY);
+    });
+    _shared_parameters.try_read(_parameters, _parameters_version);              // Stesso thread dello scrittore: la lettura riesce sempre
+    for (auto& smooth_delay : _smooth_delay)
+    {
+        smooth_delay.reset(sample_rate, 0.05);                                  // 50ms di smoothing time, come Delay
+        smooth_delay.set_current_and_target_value(static_cast<float>(MIN_DELAY));
+    }
+    update_groups();
+    update_feedback_filters();                                                  // I coefficienti dipendono dal sample rate
+    for (int c = 0; c < max_channels; c++)
+    {
+        _low_cut_filter[c].Reset();
+        _high_cut_filter[c].Reset();
+    }
+}
+
+template <typename SampleType>
+void MultiChannelDelay<SampleType>::reset()
+{
+    for (int c = 0; c < _num_channels; c++)
+        _lines[c].Reset();                                                      // O(1): i campioni non ancora scritti si leggono come zero
+    for (auto& smooth_delay : _smooth_delay)
+        smooth_delay.reset(_sample_rate, 0.05);                                 // I ritardi saltano al valore di destinazione
+    for (int c = 0; c < max_channels; c++)
+    {
+        _low_cut_filter[c].Reset();
+        _high_cut_filter[c].Reset();
+    }
+}
+
+template <typename SampleType>
+void MultiChannelDelay<SampleType>::process(juce::AudioBuffer<SampleType>& buffer)
+{
+    if (_buffer.empty() || buffer.getNumChannels() < _num_channels)
+        return;
+
+    update_parameters();                                                        // I parametri restano costanti per tutto il blocco
+
+    // Ogni gruppo usa il sotto-blocco adatto ai suoi ritardi
+    for (int group = 0; group < _num_groups; group++)
+        process_group(group, buffer);
+}
+
+template <typename SampleType>
+void MultiChannelDelay<SampleType>::process_group(int group, juce::AudioBuffer<SampleType>& buffer)
+{
+    // I gruppi non condividono canali né linee: ogni linea avanza di tutto il blocco
+    const int* channels = _group_channels + _group_start[group];
+    const int num_group_channels = _group_start[group + 1] - _group_start[group];
+    const int num_samples = buffer.getNumSamples();
+    const SampleType wet = static_cast<SampleType>(_parameters.dry_wet);
+    const SampleType dry = static_cast<SampleType>(1.f - _parameters.dry_wet);
+
+    for (int start = 0; start < num_samples;)
+    {
+        // Il sotto-blocco è più corto del ritardo minimo del gruppo: le letture non dipendono dalle scritture dello stesso sotto-blocco
+        float min_delay = static_cast<float>(_max_delay);
+        for (int i = 0; i < num_group_channels; i++)
+            min_delay = juce::jmin(min_delay, _smooth_delay[channels[i]].get_current_value(), _smooth_delay[channels[i]].get_target_value());
+        const int block_size = juce::jmin(max_block_size, num_samples - start, juce::jmax(1, static_cast<int>(min_delay) - 1));
+
+        for (int i = 0; i < num_group_channels; i++)
+        {
+            _smooth_delay[channels[i]].render(_delays[channels[i]], block_size);
+            _lines[channels[i]].ReadBlock(_delayed[channels[i]], _delays[channels[i]], static_cast<size_t>(block_size));
+        }
+
+        // Ingressi delle linee: routing degli ingressi e feedback delle uscite ritardate del gruppo
+        for (int i = 0; i < num_group_channels; i++)
+        {
+            const int c = channels[i];
+            juce::FloatVectorOperations::clear(_line_input[c], block_size);
+            for (int k = 0; k < num_group_channels; k++)
+            {
+                const int j = channels[k];
+                if (_parameters.routing[c][j] != 0.0f)
+                    juce::FloatVectorOperations::addWithMultiply(_line_input[c], buffer.getReadPointer(j, start), static_cast<SampleType>(_parameters.routing[c][j]), block_size);
+                if (_parameters.feedback[c][j] != 0.0f)
+                    juce::FloatVectorOperations::addWithMultiply(_line_input[c], _delayed[j], static_cast<SampleType>(_parameters.feedback[c][j]), block_size);
+            }
+        }
+
+        for (int i = 0; i < num_group_channels; i++)
+        {
+            const int c = channels[i];
+            SampleType* const line_input[1] = { _line_input[c] };
+            if (_low_cut_enabled)
+                _low_cut_filter[c].ProcessBlock(line_input, static_cast<size_t>(block_size));
+            if (_high_cut_enabled)
+                _high_cut_filter[c].ProcessBlock(line_input, static_cast<size_t>(block_size));
+            _lines[c].WriteBlock(_line_input[c], static_cast<size_t>(block_size));
+
+            SampleType* output = buffer.getWritePointer(c, start);
+            juce::FloatVectorOperations::multiply(output, dry, block_size);
+            juce::FloatVectorOperations::addWithMultiply(output, _delayed[c], wet, block_size);
+        }
+
+        start += block_size;
+    }
+}
+
+template <typename SampleType>
+void MultiChannelDelay<SampleType>::update_parameters()
+{
+    // Con una scrittura in corso (scrittore su un altro thread) restano i parametri precedenti, riletti al prossimo blocco
+    if (_shared_parameters.get_version() == _parameters_version || !_shared_parameters.try_read(_parameters, _parameters_version))
+        return;
+
+    for (int c = 0; c < _num_channels; c++)
+        _smooth_delay[c].set_target_value(_parameters.delay[c]);               // set_target_value ignora i ritardi invariati
+
+    update_groups();
+    update_feedback_filters();
+}
+
+template <typename SampleType>
+void MultiChannelDelay<SampleType>::update_feedback_filters()
+{
+    // Un filtro al suo estremo non viene elaborato: a filtri spenti il feedback costa come senza filtri
+    _low_cut_enabled = _parameters.low_cut > LOW_CUT_OFF;
+    _high_cut_enabled = _parameters.high_cut < HIGH_CUT_OFF;
+    for (int c = 0; c < max_channels; c++)
+    {
+        _low_cut_filter[c].SetFrequency(static_cast<float>(_parameters.low_cut / _sample_rate));
+        _high_cut_filter[c].SetFrequency(static_cast<float>(_parameters.high_cut / _sample_rate));
+    }
+}
+
+template <typename SampleType>
+void MultiChannelDelay<SampleType>::update_groups()
+{
+    // Union-find sui canali collegati da un elemento non nullo di una delle due matrici
+    int parent[max_channels];
+    for (int c = 0; c < _num_channels; c++)
+        parent[c] = c;
+
+    auto find = [&parent](int c)
+    {
+        while (parent[c] != c)
+            c = parent[c] = parent[parent[c]];
+        return c;
+    };
+
+    for (int c = 0; c < _num_channels; c++)
+        for (int j = 0; j < _num_channels; j++)
+            if (c != j && (_parameters.routing[c][j] != 0.0f || _parameters.feedback[c][j] != 0.0f))
+                parent[find(c)] = find(j);
+
+    // Canali ordinati per gruppo, i gruppi nell'ordine del loro primo canale
+    _num_groups = 0;
+    int count = 0;
+    bool assigned[max_channels] = {};
+    for (int c = 0; c < _num_channels; c++)
+    {
+        if (assigned[c])
+            continue;
+
+        const int root = find(c);
+        _group_start[_num_groups++] = count;
+        for (int j = c; j < _num_channels; j++)
+        {
+            if (!assigned[j] && find(j) == root)
+            {
+                assigned[j] = true;
+                _group_channels[count++] = j;
+            }
+        }
+    }
+    _group_start[_num_groups] = count;
+}
+
+template <typename SampleType>
+double MultiChannelDelay<SampleType>::get_tail_length_in_seconds() const
+{
+    // Dallo snapshot e non dallo stato del thread audio: può essere chiamato da qualsiasi thread.
+    // Il lettore non attende lo scrittore: se lo snapshot resta occupato si restituisce l'ultimo valore calcolato
+    Parameters parameters;
+    uint32_t version;
+    bool read = false;
+    for (int attempt = 0; attempt < TAIL_READ_ATTEMPTS && !read; attempt++)
+        read = _shared_parameters.try_read(parameters, version);
+    if (!read)
+        return _tail_length_in_seconds.load(std::memory_order_relaxed);
+
+    const double tail_length_in_seconds = tail_length(parameters);
+    _tail_length_in_seconds.store(tail_length_in_seconds, std::memory_order_relaxed);
+    return tail_length_in_seconds;
+}
+
+template <typename SampleType>
+double MultiChannelDelay<SampleType>::tail_length(const Parameters& parameters) const
+{
+    // Il guadagno per passaggio nelle linee è limitato dalla massima somma per riga dei moduli della matrice di feedback
+    float delay = 0.f;
+    float feedback = 0.f;
+    for (int c = 0; c < parameters.num_channels; c++)
+    {
+        float row = 0.f;
+        for (int j = 0; j < parameters.num_channels; j++)
+            row += std::abs(parameters.feedback[c][j]);
+        feedback = juce::jmax(feedback, row);
+        delay = juce::jmax(delay, parameters.delay[c]);
+    }
+    delay += 1.f;                                                               // Campione letto dall'interpolazione oltre il ritardo
+
+    if (feedback >= 1.f)
+        return std::numeric_limits<double>::infinity();                         // La coda non si estingue
+
+    // Come in Delay: il contenuto si accumula fino a 1 / (1 - feedback) e viene attenuato di feedback ad ogni passaggio
+    const double level = 1. / (1. - feedback);
+    double passes = 1.;
+    if (feedback > 0.f && level > SILENCE_THRESHOLD)
+        passes = juce::jmax(1., std::ceil(std::log(SILENCE_THRESHOLD / level) / std::log(static_cast<double>(feedback))));
+
+    return static_cast<double>(delay) * passes / parameters.sample_rate;
+}
+
+template <typename SampleType>
+void MultiChannelDelay<SampleType>::set_delays_in_ms(const float* delays_in_ms)
+{
+    if (_buffer.empty())
+        return;
+
+    float delays_in_samples[max_channels];
+    for (int c = 0; c < _num_channels; c++)
+        delays_in_samples[c] = static_cast<float>(juce::jlimit(MIN_DELAY, _max_delay,
+            juce::roundToInt(delays_in_ms[c] * _sample_rate / 1000.f)));
+
+    const int num_channels = _num_channels;
+    _shared_parameters.update([&](Parameters& parameters)
+    {
+        for (int c = 0; c < num_channels; c++)
+            parameters.delay[c] = delays_in_samples[c];
+    });
+}
+
+template <typename SampleType>
+void MultiChannelDelay<SampleType>::set_routing_matrix(const float* matrix)
+{
+    const int num_channels = _num_channels;
+    _shared_parameters.update([&](Parameters& parameters)
+    {
+        for (int c = 0; c < num_channels; c++)
+            for (int j = 0; j < num_channels; j++)
+                parameters.routing[c][j] = juce::jlimit(-1.f, 1.f, matrix[c * num_channels + j]);
+    });
+}
+
+template <typename SampleType>
+void MultiChannelDelay<SampleType>::set_feedback_matrix(const float* matrix)
+{
+    const int num_channels = _num_channels;
+    _shared_parameters.update([&](Parameters& parameters)
+    {
+        for (int c = 0; c < num_channels; c++)
+            for (int j = 0; j < num_channels; j++)
+                parameters.feedback[c][j] = juce::jlimit(-1.f, 1.f, matrix[c * num_channels + j]);
+    });
+}
+
+template <typename SampleType>
+void MultiChannelDelay<SampleType>::set_dry_wet(float dry_wet)
+{
+    _shared_parameters.update([dry_wet](Parameters& parameters) { parameters.dry_wet = juce::jlimit(0.f, 1.f, dry_wet); });
+}
+
+template <typename SampleType>
+void MultiChannelDelay<SampleType>::set_low_cut(float frequency)
+{
+    _shared_parameters.update([frequency](Parameters& parameters) { parameters.low_cut = juce::jlimit(LOW_CUT_OFF, HIGH_CUT_OFF, frequency); });
+}
+
+template <typename SampleType>
+void MultiChannelDelay<SampleType>::set_high_cut(float frequency)
+{
+    _shared_parameters.update([frequency](Parameters& parameters) { parameters.high_cut = juce::jlimit(LOW_CUT_OFF, HIGH_CUT_OFF, frequency); });
+}
+
+template class MultiChannelDelay<float>;
+template class MultiChannelDelay<double>;
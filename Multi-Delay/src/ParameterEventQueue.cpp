@@ -0,0 +1,132 @@
+// Classe ParameterEventQueue per il passaggio dei cambi di parametro al thread audio
+// Ogni evento contiene l'indice del parametro, il nuovo valore e la posizione (in campioni) nel blocco
+// in cui deve essere applicato; il thread audio divide il blocco nei punti di cambio, così
+// l'automazione è applicata al campione e non solo ai bordi del blocco.
+// La coda è un anello a capacità fissa senza lock, con più scrittori e un solo lettore: ogni cella ha un
+// numero di sequenza che indica se è libera o pubblicata. Uno scrittore prenota una cella con un
+// compare-and-swap sulla posizione di scrittura e la pubblica dopo averla scritta: nessun thread attende
+// un altro, quindi l'automazione dell'host (sul thread audio) non resta mai bloccata da un thread
+// dell'interfaccia interrotto. Una cella prenotata e non ancora pubblicata ferma la lettura fino al
+// prossimo blocco, senza attese.
+// La classe prevede un oggetto ParameterEventQueue con i seguenti parametri:
+//      - _cells: Celle dell'anello (evento e numero di sequenza)
+//      - _write_position: Prossima posizione da prenotare (scrittori)
+//      - _read_position: Prossima posizione da leggere (solo il lettore)
+//      - _overflow: Indica che un evento è stato scartato a coda piena
+// Per scrivere gli eventi si utilizzano i metodi:
+//      - push(const ParameterEvent& event) che accoda un evento da qualsiasi thread (false se la coda è piena)
+// Per leggere gli eventi (thread audio, oppure un altro thread con l'audio fermo) si utilizzano i metodi:
+//      - pop_all(ParameterEvent* events, int max_events) che estrae gli eventi ordinati per posizione; per lo stesso
+//        parametro resta l'ordine di arrivo
+//      - take_overflow() che indica (e azzera) se degli eventi sono stati scartati
+//      - clear() per scartare gli eventi in attesa
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "ParameterEventQueue.h"
+
+
+static_assert((ParameterEventQueue::capacity & (ParameterEventQueue::capacity - 1)) == 0, "capacity deve essere una potenza di 2");
+
+
+ParameterEventQueue::ParameterEventQueue() : _write_position(0), _read_position(0), _overflow(false)
+{
+    for (uint32_t i = 0; i < static_cast<uint32_t>(capacity); i++)
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+bool ParameterEventQueue::push(const ParameterEvent& event)
+{
+    uint32_t position = _write_position.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Cell& cell = _cells[position & (capacity - 1)];
+        const int32_t distance = static_cast<int32_t>(cell.sequence.load(std::memory_order_acquire) - position);
+
+        if (distance == 0)
+        {
+            // Cella libera: la prenota; se un altro scrittore l'ha presa prima, riprova con la posizione aggiornata
+            if (_write_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                cell.event = event;
+                cell.sequence.store(position + 1, std::memory_order_release);  // Pubblica l'evento al lettore
+                return true;
+            }
+        }
+        else if (distance < 0)
+        {
+            // La cella contiene ancora un evento non letto: coda piena
+            _overflow.store(true, std::memory_order_release);  // Il lettore recupera i valori correnti dei parametri
+            return false;
+        }
+        else
+        {
+            position = _write_position.load(std::memory_order_relaxed);   // Un altro scrittore è andato avanti
+        }
+    }
+}
+
+int ParameterEventQueue::pop_all(ParameterEvent* events, int max_events)
+{
+    // Lettura fino alla prima cella non pubblicata: una cella prenotata da uno scrittore interrotto
+    // viene letta al prossimo blocco, il lettore non la attende
+    int num_events = 0;
+    while (num_events < max_events)
+    {
+        Cell& cell = _cells[_read_position & (capacity - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != _read_position + 1)
+            break;
+
+        events[num_events++] = cell.event;
+        cell.sequence.store(_read_position + capacity, std::memory_order_release);  // Libera la cella per il prossimo giro
+        _read_position++;
+    }
+
+    // Per lo stesso parametro vale l'ordine di arrivo: un evento non può precedere quello arrivato prima
+    // (ad es. un cambio dall'interfaccia stimato a 300 seguito dall'automazione dell'host a 0), quindi la
+    // sua posizione viene portata almeno a quella dell'evento precedente dello stesso parametro
+    for (int i = 1; i < num_events; i++)
+    {
+        for (int j = i - 1; j >= 0; j--)
+        {
+            if (events[j].parameter == events[i].parameter)
+            {
+                events[i].sample_offset = juce::jmax(events[i].sample_offset, events[j].sample_offset);
+                break;                                          // events[j] è già stato portato oltre i precedenti
+            }
+        }
+    }
+
+    // Ordinamento per inserzione (stabile, senza allocazioni): gli eventi arrivano quasi sempre già in
+    // ordine, a parità di posizione resta l'ordine di arrivo
+    for (int i = 1; i < num_events; i++)
+    {
+        const ParameterEvent event = events[i];
+        int j = i;
+        for (; j > 0 && events[j - 1].sample_offset > event.sample_offset; j--)
+            events[j] = events[j - 1];
+        events[j] = event;
+    }
+
+    return num_events;
+}
+
+bool ParameterEventQueue::take_overflow()
+{
+    return _overflow.exchange(false, std::memory_order_acquire);
+}
+
+void ParameterEventQueue::clear()
+{
+    // Lato lettore: gli scrittori possono continuare ad accodare, gli eventi già pubblicati vengono scartati
+    for (;;)
+    {
+        Cell& cell = _cells[_read_position & (capacity - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != _read_position + 1)
+            break;
+
+        cell.sequence.store(_read_position + capacity, std::memory_order_release);
+        _read_position++;
+    }
+    _overflow.store(false, std::memory_order_relaxed);
+}
@@ -0,0 +1,67 @@
+// Classe ParameterEventQueue per il passaggio dei cambi di parametro al thread audio
+// Ogni evento contiene l'indice del parametro, il nuovo valore e la posizione (in campioni) nel blocco
+// in cui deve essere applicato; il thread audio divide il blocco nei punti di cambio, così
+// l'automazione è applicata al campione e non solo ai bordi del blocco.
+// La coda è un anello a capacità fissa senza lock, con più scrittori e un solo lettore: ogni cella ha un
+// numero di sequenza che indica se è libera o pubblicata. Uno scrittore prenota una cella con un
+// compare-and-swap sulla posizione di scrittura e la pubblica dopo averla scritta: nessun thread attende
+// un altro, quindi l'automazione dell'host (sul thread audio) non resta mai bloccata da un thread
+// dell'interfaccia interrotto. Una cella prenotata e non ancora pubblicata ferma la lettura fino al
+// prossimo blocco, senza attese.
+// La classe prevede un oggetto ParameterEventQueue con i seguenti parametri:
+//      - _cells: Celle dell'anello (evento e numero di sequenza)
+//      - _write_position: Prossima posizione da prenotare (scrittori)
+//      - _read_position: Prossima posizione da leggere (solo il lettore)
+//      - _overflow: Indica che un evento è stato scartato a coda piena
+// Per scrivere gli eventi si utilizzano i metodi:
+//      - push(const ParameterEvent& event) che accoda un evento da qualsiasi thread (false se la coda è piena)
+// Per leggere gli eventi (thread audio, oppure un altro thread con l'audio fermo) si utilizzano i metodi:
+//      - pop_all(ParameterEvent* events, int max_events) che estrae gli eventi ordinati per posizione; per lo stesso
+//        parametro resta l'ordine di arrivo
+//      - take_overflow() che indica (e azzera) se degli eventi sono stati scartati
+//      - clear() per scartare gli eventi in attesa
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef __PARAMETER_EVENT_QUEUE_HPP__
+#define __PARAMETER_EVENT_QUEUE_HPP__
+
+#include <juce_audio_basics/juce_audio_basics.h>                // Libreria JUCE
+#include <atomic>
+#include <cstdint>
+
+struct ParameterEvent                                           // Cambio di un parametro
+{
+    int parameter;                                              // Indice del parametro
+    float value;                                                // Nuovo valore
+    int sample_offset;                                          // Posizione nel blocco in cui applicarlo
+};
+
+class ParameterEventQueue
+{
+public:
+    static constexpr int capacity = 512;                        // Numero massimo di eventi in attesa (potenza di 2)
+
+private:
+    struct Cell
+    {
+        std::atomic<uint32_t> sequence;                         // == posizione: libera, == posizione + 1: pubblicata
+        ParameterEvent event;
+    };
+
+    Cell _cells[capacity];                                      // Celle dell'anello
+    std::atomic<uint32_t> _write_position;                      // Prossima posizione da prenotare
+    uint32_t _read_position;                                    // Prossima posizione da leggere
+    std::atomic<bool> _overflow;                                // Evento scartato a coda piena
+
+public:
+    ParameterEventQueue();                                      // Costruttore dell'oggetto ParameterEventQueue
+
+    bool push(const ParameterEvent& event);                     // Accoda un evento (da qualsiasi thread, senza lock)
+
+    int pop_all(ParameterEvent* events, int max_events);        // Estrae gli eventi ordinati per posizione
+    bool take_overflow();                                       // Eventi scartati dall'ultima chiamata
+    void clear();                                               // Scarta gli eventi in attesa (lato lettore)
+};
+
+#endif // __PARAMETER_EVENT_QUEUE_HPP__
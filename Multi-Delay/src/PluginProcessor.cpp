@@ -1,364 +1,820 @@
-#include "PluginProcessor.h"
-
-//==============================================================================
-AudioPluginAudioProcessor::AudioPluginAudioProcessor() : AudioProcessor(BusesProperties()
-#if !JucePlugin_IsMidiEffect
-#if !JucePlugin_IsSynth
-                                                                                .withInput("Input", juce::AudioChannelSet::stereo(), true)
-#endif
-                                                                                .withOutput("Output", juce::AudioChannelSet::stereo(), true)
-#endif
-),
-                                                         parameters{*this, nullptr, juce::Identifier("parameters"), createParameterLayout()}
-{   // Parametri dell'interfaccia grafica
-    // Delay Parameters
-    parameters.addParameterListener("delay-sx", this);
-    parameters.addParameterListener("delay-dx", this);
-    parameters.addParameterListener("feedback", this);
-    parameters.addParameterListener("dry-wet", this);
-    parameters.addParameterListener("sync-enable", this);
-    parameters.addParameterListener("delay-mode", this);
-    parameters.addParameterListener("pingpong-mode", this);
-    // Pan Parameters
-    parameters.addParameterListener("pan", this);
-    // LFO Parameters
-    parameters.addParameterListener("rate", this);
-    parameters.addParameterListener("amount", this);
-    parameters.addParameterListener("shape", this);
-}
-
-
-AudioPluginAudioProcessor::~AudioPluginAudioProcessor()    // Distruttore dell'oggetto AudioPluginAudioProcessor
-{   // Rimozione dei parametri
-    parameters.removeParameterListener("delay-sx", this);
-    parameters.removeParameterListener("delay-dx", this);
-    parameters.removeParameterListener("feedback", this);
-    parameters.removeParameterListener("dry-wet", this);
-    parameters.removeParameterListener("sync-enable", this);
-    parameters.removeParameterListener("delay-mode", this);
-    parameters.removeParameterListener("pingpong-mode", this);
-    parameters.removeParameterListener("pan", this);
-    parameters.removeParameterListener("rate", this);
-    parameters.removeParameterListener("amount", this);
-    parameters.removeParameterListener("shape", this);
-}
-
-juce::AudioProcessorValueTreeState::ParameterLayout AudioPluginAudioProcessor::createParameterLayout()  // Metodo per creare il layout dei parametri
-{
-    juce::AudioProcessorValueTreeState::ParameterLayout layout;
-    // Delay
-    layout.add(std::make_unique<juce::AudioParameterChoice>("delay-mode", "Delay Mode", juce::StringArray({ "feedback", "pingpong"}), 0));
-    layout.add(std::make_unique<juce::AudioParameterChoice>("pingpong-mode", "Pingpong Mode", juce::StringArray({ "center", "left", "right" }), 0));
-    layout.add(std::make_unique<juce::AudioParameterBool>("sync-enable", "Sync", false));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-            "delay-sx", "Delay Sx/Master", juce::NormalisableRange<float>(0.0f, 500.0f, 0.1f), 150.0f, juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
-            { return juce::String(val) + juce::String(" ms"); },
-            [](juce::String str) -> float
-            {
-                return str.getFloatValue();
-            }));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-            "delay-dx", "Delay Dx", juce::NormalisableRange<float>(0.0f, 500.0f, 0.1f), 100.0f, juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
-            { return juce::String(val) + juce::String(" ms"); },
-            [](juce::String str) -> float
-            {
-                return str.getFloatValue();
-            }));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-            "feedback", "Feedback", juce::NormalisableRange<float>(0.0f, juce::Decibels::decibelsToGain<float>(0.0f), 0.0005f, 0.4f), 0.1f, juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
-            { return juce::String(juce::Decibels::gainToDecibels(val)) + juce::String(" dB"); },
-            [](juce::String val)
-            {
-                return juce::Decibels::decibelsToGain<float>(val.getFloatValue());
-            }));
-    layout.add(std::make_unique<juce::AudioParameterInt>(
-            "dry-wet", "Dry/Wet", 0, 100, 15, juce::String{}, [](int val, int)
-            { return juce::String(static_cast<int>(val)) + juce::String(" %"); },
-            [](juce::String val)
-            {
-                return val.getIntValue();
-            }));
-
-
-    // LFO
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-            "rate", "Rate", juce::NormalisableRange<float>(0.1f, 5.0f, 0.05f), 1.0f, juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
-            { return juce::String(val) + juce::String(" Hz"); },
-            [](juce::String str) -> float
-            {
-                return str.getFloatValue();
-            }));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-            "amount", "Amount", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.0f, juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
-            { return juce::String(val * 100) + juce::String(" %"); },
-            [](juce::String str) -> float
-            {
-                return str.getFloatValue();
-            }));
-    layout.add(std::make_unique<juce::AudioParameterChoice>("shape", "Shape", juce::StringArray({"Sine", "Saw", "Square"}), 0));
-
-    // Pan
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-            "pan", "Pan", juce::NormalisableRange<float>(-1.0f, 1.0f, 0.1f), 0.0f, juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
-            { return juce::String(val) + juce::String(" "); },
-            [](juce::String str) -> float
-            {
-                return str.getFloatValue();
-            }));
-
-    return layout;
-}
-
-void AudioPluginAudioProcessor::parameterChanged(const juce::String &id, float newValue)  // Metodo per gestire i cambiamenti dei parametri
-{
-    juce::ignoreUnused(id, newValue);
-
-    if (id == "delay-sx")
-    {
-        delay.set_delay_sx_in_ms(newValue);
-    }
-    else if (id == "delay-dx")
-    {
-        delay.set_delay_dx_in_ms(newValue);
-    }
-    else if (id == "sync-enable")
-    {
-        delay.enable_sync(newValue >= 0.5f); // Correzione qui: convertiamo correttamente a bool
-    }
-    else if (id == "delay-mode")
-    {
-        delay.set_delay_mode(static_cast<int>(newValue));
-    }
-    else if (id == "pingpong-mode")
-    {
-        delay.set_pingpong_mode(static_cast<int>(newValue));
-    }
-    else if (id == "feedback")
-    {
-        delay.set_feedback(newValue);
-    }
-    else if (id == "dry-wet")
-    {
-        delay.set_dry_wet(newValue / 100.f);
-    }
-
-    if (id == "rate")
-    {
-        lfo.set_rate(newValue);
-    }
-    else if (id == "amount")
-    {
-        lfo.set_amount(newValue);
-    }
-    else if (id == "shape")
-    {
-        lfo.set_shape(static_cast<int>(newValue));
-    }
-}
-
-//==============================================================================
-const juce::String AudioPluginAudioProcessor::getName() const
-{
-#ifdef PLUGIN_NAME
-    return PLUGIN_NAME;
-#else
-    return "";
-#endif
-}
-
-bool AudioPluginAudioProcessor::acceptsMidi() const
-{
-#if JucePlugin_WantsMidiInput
-    return true;
-#else
-    return false;
-#endif
-}
-
-bool AudioPluginAudioProcessor::producesMidi() const
-{
-#if JucePlugin_ProducesMidiOutput
-    return true;
-#else
-    return false;
-#endif
-}
-
-bool AudioPluginAudioProcessor::isMidiEffect() const
-{
-#if JucePlugin_IsMidiEffect
-    return true;
-#else
-    return false;
-#endif
-}
-
-double AudioPluginAudioProcessor::getTailLengthSeconds() const
-{
-    return 0.0;
-}
-
-int AudioPluginAudioProcessor::getNumPrograms()
-{
-    return 1; // NB: some hosts don't cope very well if you tell them there are 0 programs,
-              // so this should be at least 1, even if you're not really implementing programs.
-}
-
-int AudioPluginAudioProcessor::getCurrentProgram()
-{
-    return 0;
-}
-
-void AudioPluginAudioProcessor::setCurrentProgram(int index)
-{
-    juce::ignoreUnused(index);
-}
-
-const juce::String AudioPluginAudioProcessor::getProgramName(int index)
-{
-    juce::ignoreUnused(index);
-    return {};
-}
-
-void AudioPluginAudioProcessor::changeProgramName(int index, const juce::String &newName)
-{
-    juce::ignoreUnused(index, newName);
-}
-
-//==============================================================================
-void AudioPluginAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
-{
-    // Use this method as the place to do any pre-playback
-    // initialisation that you need..
-    juce::ignoreUnused(sampleRate, samplesPerBlock);
-
-    delay.prepare(sampleRate, samplesPerBlock);
-
-    delay.enable_sync(static_cast<int>(*parameters.getRawParameterValue("sync-enable")));
-    delay.set_delay_mode(static_cast<int>(*parameters.getRawParameterValue("delay-mode")));
-    delay.set_pingpong_mode(static_cast<int>(*parameters.getRawParameterValue("pingpong-mode")));
-
-    delay.set_delay_dx_in_ms(*parameters.getRawParameterValue("delay-dx"));
-    delay.set_delay_sx_in_ms(*parameters.getRawParameterValue("delay-sx"));
-
-    delay.set_feedback(*parameters.getRawParameterValue("feedback"));
-    delay.set_dry_wet(*parameters.getRawParameterValue("dry-wet") / 100);
-
-    lfo.set_rate(*parameters.getRawParameterValue("rate"));
-    lfo.set_shape(static_cast<int>(*parameters.getRawParameterValue("shape")));
-    lfo.set_amount(*parameters.getRawParameterValue("amount"));
-
-
-
-}
-
-void AudioPluginAudioProcessor::releaseResources()
-{
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
-
-    // TODO: if needed release any attribute/dependency which has memory allocated
-    pan.reset();
-    delay.reset();
-}
-
-bool AudioPluginAudioProcessor::isBusesLayoutSupported(const BusesLayout &layouts) const
-{
-#if JucePlugin_IsMidiEffect
-    juce::ignoreUnused(layouts);
-    return true;
-#else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo() && layouts.getMainInputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
-
-        // This checks if the input layout matches the output layout
-#if !JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-        return false;
-#endif
-
-    return true;
-#endif
-}
-
-void AudioPluginAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
-                                             juce::MidiBuffer &midiMessages)
-{
-    juce::ignoreUnused(midiMessages);
-
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
-
-    // In case we have more outputs than inputs, this code clears any output
-    // channels that didn't contain input data, (because these aren't
-    // guaranteed to be empty - they may contain garbage).
-    // This is here to avoid people getting screaming feedback
-    // when they first compile a plugin, but obviously you don't need to keep
-    // this code if your algorithm always overwrites all the output channels.
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear(i, 0, buffer.getNumSamples());
-
-    // TODO: add your logic
-    auto sampleRate = getSampleRate();                                                      // Ottiene il sample rate
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)                       // Per ogni canale
-    {
-        auto *channelData = buffer.getWritePointer(channel);                                // Ottiene il puntatore al canale
-
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)                     // Per ogni campione
-        {
-            float lfoValue = (lfo.getNextValue(sampleRate));                                // Ottiene il valore successivo dell'LFO
-            pan.set_pan(*parameters.getRawParameterValue("pan") + lfoValue);                // Imposta il panning in base al parametro pan e al valore dell'LFO
-        }
-    }
-    delay.process(buffer);                                                                  // Applica l'effetto delay al buffer
-    pan.process(buffer);                                                                    // Applica il panning al buffer
-    
-    
-
-}
-
-//==============================================================================
-bool AudioPluginAudioProcessor::hasEditor() const
-{
-    return true; // (change this to false if you choose to not supply an editor)
-}
-
-juce::AudioProcessorEditor *AudioPluginAudioProcessor::createEditor()
-{
-    return new juce::GenericAudioProcessorEditor(*this); // Use the generic editor
-}
-
-//==============================================================================
-void AudioPluginAudioProcessor::getStateInformation(juce::MemoryBlock &destData)
-{
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-
-    juce::MemoryOutputStream mos{destData, true};
-    parameters.state.writeToStream(mos);
-}
-
-void AudioPluginAudioProcessor::setStateInformation(const void *data, int sizeInBytes)
-{
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
-    auto tree = juce::ValueTree::readFromData(data, static_cast<std::size_t>(sizeInBytes));
-    if (tree.isValid())
-    {
-        parameters.replaceState(tree);
-    }
-}
-
-//==============================================================================
-// This creates new instances of the plugin..
-juce::AudioProcessor *JUCE_CALLTYPE createPluginFilter()
-{
-    return new AudioPluginAudioProcessor();
-}
+#include "PluginProcessor.h"
+
+static juce::String tapParameterID(int tap, const char* name)  // ID dei parametri dei tap: "tap-1-time", "tap-1-gain", ...
+{
+    return "tap-" + juce::String(tap + 1) + "-" + name;
+}
+
+template <typename SampleType>
+static void setDelayParameter(Delay<SampleType> &delay, int parameter, float newValue)  // Applica un parametro del delay a un'istanza di Delay
+{
+    using Parameter = AudioPluginAudioProcessor::ParameterIndex;
+
+    switch (parameter)
+    {
+    case Parameter::delaySxParameter:
+        delay.set_delay_sx_in_ms(newValue);
+        break;
+    case Parameter::delayDxParameter:
+        delay.set_delay_dx_in_ms(newValue);
+        break;
+    case Parameter::syncEnableParameter:
+        delay.enable_sync(newValue >= 0.5f); // Correzione qui: convertiamo correttamente a bool
+        break;
+    case Parameter::delayModeParameter:
+        delay.set_delay_mode(static_cast<int>(newValue));
+        break;
+    case Parameter::pingpongModeParameter:
+        delay.set_pingpong_mode(static_cast<int>(newValue));
+        break;
+    case Parameter::interpolationParameter:
+        delay.set_interpolation(static_cast<int>(newValue));
+        break;
+    case Parameter::feedbackParameter:
+        delay.set_feedback(newValue);
+        break;
+    case Parameter::dryWetParameter:
+        delay.set_dry_wet(newValue / 100.f);
+        break;
+    case Parameter::tapsParameter:
+        delay.set_num_taps(static_cast<int>(newValue));
+        break;
+    case Parameter::fdnLinesParameter:
+        delay.set_fdn_lines(4 << static_cast<int>(newValue));  // Scelte "4", "8", "16"
+        break;
+    case Parameter::fdnMatrixParameter:
+        delay.set_fdn_matrix(static_cast<int>(newValue));
+        break;
+    case Parameter::lowCutParameter:
+        delay.set_low_cut(newValue);
+        break;
+    case Parameter::highCutParameter:
+        delay.set_high_cut(newValue);
+        break;
+    default:
+        // Parametri dei tap: un gruppo di max_taps indici per ogni parametro ("tap-2-gain" -> tapGainParameter + 1)
+        if (parameter >= Parameter::tapTimeParameter && parameter < Parameter::tapGainParameter)
+            delay.set_tap_delay_in_ms(parameter - Parameter::tapTimeParameter, newValue);
+        else if (parameter >= Parameter::tapGainParameter && parameter < Parameter::tapPanParameter)
+            delay.set_tap_gain(parameter - Parameter::tapGainParameter, newValue);
+        else if (parameter >= Parameter::tapPanParameter && parameter < Parameter::tapFeedbackParameter)
+            delay.set_tap_pan(parameter - Parameter::tapPanParameter, newValue);
+        else if (parameter >= Parameter::tapFeedbackParameter && parameter < Parameter::fdnLinesParameter)
+            delay.set_tap_feedback(parameter - Parameter::tapFeedbackParameter, newValue);
+        break;
+    }
+}
+
+//==============================================================================
+AudioPluginAudioProcessor::AudioPluginAudioProcessor() : AudioProcessor(BusesProperties()
+#if !JucePlugin_IsMidiEffect
+#if !JucePlugin_IsSynth
+                                                                                .withInput("Input", juce::AudioChannelSet::stereo(), true)
+#endif
+                                                                                .withOutput("Output", juce::AudioChannelSet::stereo(), true)
+#endif
+),
+                                                         parameters{*this, nullptr, juce::Identifier("parameters"), createParameterLayout()}
+{   // Parametri dell'interfaccia grafica
+    // Parametri applicati dal thread audio, nell'ordine di ParameterIndex; ognuno ha un listener con il suo indice
+    parameterIDs.addArray({ "delay-sx", "delay-dx", "sync-enable", "delay-mode", "pingpong-mode", "interpolation", "feedback", "dry-wet", "taps" });
+    for (const char* name : { "time", "gain", "pan", "feedback" })
+        for (int tap = 0; tap < DelayTypes::max_taps; ++tap)
+            parameterIDs.add(tapParameterID(tap, name));
+    parameterIDs.addArray({ "fdn-lines", "fdn-matrix", "low-cut", "high-cut", "rate", "amount", "shape", "pan" });
+    jassert(parameterIDs.size() == numParameters);
+
+    for (int parameter = 0; parameter < numParameters; ++parameter)
+    {
+        parameterValues[parameter] = parameters.getRawParameterValue(parameterIDs[parameter]);
+        parameterListeners.push_back(std::make_unique<ParameterListener>(*this, parameter));
+        parameters.addParameterListener(parameterIDs[parameter], parameterListeners.back().get());
+    }
+
+    panModulation.assign(512, 0.0f);                                                        // Ridimensionato in prepareToPlay
+
+    startTimer(50);                                                                         // Linee fdn richieste dal thread audio, entro 50ms
+}
+
+
+AudioPluginAudioProcessor::~AudioPluginAudioProcessor()    // Distruttore dell'oggetto AudioPluginAudioProcessor
+{   // Rimozione dei parametri
+    stopTimer();
+    for (int parameter = 0; parameter < numParameters; ++parameter)
+        parameters.removeParameterListener(parameterIDs[parameter], parameterListeners[static_cast<size_t>(parameter)].get());
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout AudioPluginAudioProcessor::createParameterLayout()  // Metodo per creare il layout dei parametri
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    // Delay
+    layout.add(std::make_unique<juce::AudioParameterChoice>("delay-mode", "Delay Mode", juce::StringArray({ "feedback", "pingpong", "multitap", "fdn"}), 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("pingpong-mode", "Pingpong Mode", juce::StringArray({ "center", "left", "right" }), 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("interpolation", "Interpolation", juce::StringArray({ "none", "linear", "hermite", "lagrange", "allpass" }), 1));
+    layout.add(std::make_unique<juce::AudioParameterBool>("sync-enable", "Sync", false));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "delay-sx", "Delay Sx/Master", juce::NormalisableRange<float>(0.0f, 500.0f, 0.1f), 150.0f, juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
+            { return juce::String(val) + juce::String(" ms"); },
+            [](juce::String str) -> float
+            {
+                return str.getFloatValue();
+            }));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "delay-dx", "Delay Dx", juce::NormalisableRange<float>(0.0f, 500.0f, 0.1f), 100.0f, juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
+            { return juce::String(val) + juce::String(" ms"); },
+            [](juce::String str) -> float
+            {
+                return str.getFloatValue();
+            }));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "feedback", "Feedback", juce::NormalisableRange<float>(0.0f, juce::Decibels::decibelsToGain<float>(0.0f), 0.0005f, 0.4f), 0.1f, juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
+            { return juce::String(juce::Decibels::gainToDecibels(val)) + juce::String(" dB"); },
+            [](juce::String val)
+            {
+                return juce::Decibels::decibelsToGain<float>(val.getFloatValue());
+            }));
+    // Filtri nel feedback: agli estremi (20 Hz, 20 kHz) sono spenti
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "low-cut", "Low Cut", juce::NormalisableRange<float>(20.0f, 2000.0f, 1.0f, 0.3f), 20.0f, juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
+            { return val <= 20.0f ? juce::String("Off") : juce::String(juce::roundToInt(val)) + juce::String(" Hz"); },
+            [](juce::String str) -> float
+            {
+                return str.getFloatValue();
+            }));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "high-cut", "High Cut", juce::NormalisableRange<float>(500.0f, 20000.0f, 1.0f, 0.3f), 20000.0f, juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
+            { return val >= 20000.0f ? juce::String("Off") : juce::String(juce::roundToInt(val)) + juce::String(" Hz"); },
+            [](juce::String str) -> float
+            {
+                return str.getFloatValue();
+            }));
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+            "dry-wet", "Dry/Wet", 0, 100, 15, juce::String{}, [](int val, int)
+            { return juce::String(static_cast<int>(val)) + juce::String(" %"); },
+            [](juce::String val)
+            {
+                return val.getIntValue();
+            }));
+
+    // Multitap (usati con delay-mode = multitap)
+    layout.add(std::make_unique<juce::AudioParameterInt>("taps", "Taps", 1, DelayTypes::max_taps, DelayTypes::max_taps));
+    for (int tap = 0; tap < DelayTypes::max_taps; ++tap)
+    {
+        const juce::String name = "Tap " + juce::String(tap + 1) + " ";
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+                tapParameterID(tap, "time"), name + "Time", juce::NormalisableRange<float>(0.0f, 500.0f, 0.1f), 125.0f * static_cast<float>(tap + 1), juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
+                { return juce::String(val) + juce::String(" ms"); },
+                [](juce::String str) -> float
+                {
+                    return str.getFloatValue();
+                }));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+                tapParameterID(tap, "gain"), name + "Gain", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 1.0f / static_cast<float>(tap + 1), juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
+                { return juce::String(val * 100) + juce::String(" %"); },
+                [](juce::String str) -> float
+                {
+                    return str.getFloatValue();
+                }));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+                tapParameterID(tap, "pan"), name + "Pan", juce::NormalisableRange<float>(-1.0f, 1.0f, 0.1f), (tap % 2 == 0) ? -0.5f : 0.5f, juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
+                { return juce::String(val) + juce::String(" "); },
+                [](juce::String str) -> float
+                {
+                    return str.getFloatValue();
+                }));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+                tapParameterID(tap, "feedback"), name + "Feedback", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.0f, juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
+                { return juce::String(val * 100) + juce::String(" %"); },
+                [](juce::String str) -> float
+                {
+                    return str.getFloatValue();
+                }));
+    }
+
+    // FDN (usati con delay-mode = fdn): linee mescolate da una matrice ortogonale, ritardi derivati da delay-sx/delay-dx
+    layout.add(std::make_unique<juce::AudioParameterChoice>("fdn-lines", "FDN Lines", juce::StringArray({ "4", "8", "16" }), 1));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("fdn-matrix", "FDN Matrix", juce::StringArray({ "hadamard", "householder" }), 0));
+
+    // LFO
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "rate", "Rate", juce::NormalisableRange<float>(0.1f, 5.0f, 0.05f), 1.0f, juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
+            { return juce::String(val) + juce::String(" Hz"); },
+            [](juce::String str) -> float
+            {
+                return str.getFloatValue();
+            }));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "amount", "Amount", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.0f, juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
+            { return juce::String(val * 100) + juce::String(" %"); },
+            [](juce::String str) -> float
+            {
+                return str.getFloatValue();
+            }));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("shape", "Shape", juce::StringArray({"Sine", "Saw", "Square"}), 0));
+
+    // Pan
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "pan", "Pan", juce::NormalisableRange<float>(-1.0f, 1.0f, 0.1f), 0.0f, juce::String{}, juce::AudioProcessorParameter::Category::genericParameter, [](float val, int) -> juce::String
+            { return juce::String(val) + juce::String(" "); },
+            [](juce::String str) -> float
+            {
+                return str.getFloatValue();
+            }));
+
+    return layout;
+}
+
+AudioPluginAudioProcessor::ParameterListener::ParameterListener(AudioPluginAudioProcessor &owner, int index)
+    : processor(owner), parameter(index)
+{
+}
+
+void AudioPluginAudioProcessor::ParameterListener::parameterChanged(const juce::String &, float newValue)
+{
+    processor.parameterChanged(parameter, newValue);                                        // L'indice è fissato alla registrazione
+}
+
+void AudioPluginAudioProcessor::parameterChanged(int parameter, float newValue)  // Metodo per gestire i cambiamenti dei parametri
+{
+    // Può essere chiamato da qualsiasi thread, anche da più thread audio dell'host: il cambio viene solo
+    // accodato (senza allocazioni né lock) e applicato dal thread audio nella posizione stimata del prossimo blocco
+    queueParameterChange(parameter, newValue, estimateSampleOffset());
+}
+
+void AudioPluginAudioProcessor::timerCallback()
+{
+    // Message thread: le linee fdn vengono allocate qui, in prepareToPlay e in setStateInformation, mai dai listener
+    // dei parametri. Le linee dei parametri correnti sono di norma pronte prima che il thread audio applichi il cambio
+    if (isUsingDoublePrecision())
+        reserveFdnLines(delayDouble);
+    else
+        reserveFdnLines(delay);
+    delay.reserve_fdn_lines(delay.get_fdn_lines_needed());
+    delayDouble.reserve_fdn_lines(delayDouble.get_fdn_lines_needed());
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::reserveFdnLines(Delay<SampleType> &delayToReserve)
+{
+    // Valori correnti dei parametri: possono precedere i cambi non ancora applicati dal thread audio
+    if (static_cast<int>(parameterValues[delayModeParameter]->load()) == DelayTypes::mode_fdn)
+        delayToReserve.reserve_fdn_lines(4 << static_cast<int>(parameterValues[fdnLinesParameter]->load()));
+}
+
+void AudioPluginAudioProcessor::queueParameterChange(int parameter, float newValue, int sampleOffset)
+{
+    if (parameter < 0 || parameter >= numParameters)
+        return;
+
+    // A coda piena l'evento viene scartato: il thread audio rilegge allora i valori correnti di tutti i parametri
+    parameterEvents.push({ parameter, newValue, juce::jmax(0, sampleOffset) });
+}
+
+int AudioPluginAudioProcessor::getParameterIndex(const juce::String &id) const
+{
+    return parameterIDs.indexOf(id);                                                        // Ricerca lineare: l'indice va calcolato prima del thread audio
+}
+
+bool AudioPluginAudioProcessor::isParameterActive(int parameter) const
+{
+    // Con più di due canali l'effetto è del delay multicanale: feedback e pingpong (con le sotto-modalità),
+    // ritardi, dry/wet e filtri del feedback, letture con interpolazione lineare. Tap e linee fdn (le modalità
+    // multitap e fdn sono elaborate come feedback), interpolazione, panning e LFO non hanno effetto
+    if (!useMultiChannelDelay)
+        return true;
+
+    if (parameter >= tapTimeParameter && parameter < fdnLinesParameter)
+        return false;
+
+    switch (parameter)
+    {
+    case tapsParameter:
+    case fdnLinesParameter:
+    case fdnMatrixParameter:
+    case interpolationParameter:
+    case panParameter:
+    case rateParameter:
+    case amountParameter:
+    case shapeParameter:
+        return false;
+    default:
+        return true;
+    }
+}
+
+int AudioPluginAudioProcessor::estimateSampleOffset() const
+{
+    // L'automazione consegnata dall'host sul thread audio precede il blocco: si applica dal primo campione.
+    // Limite: i wrapper di JUCE passano all'AudioProcessorValueTreeState solo il valore del parametro, non la
+    // posizione del punto di automazione nel blocco, quindi l'automazione dell'host resta quantizzata al blocco.
+    // L'accuratezza al campione vale per i cambi accodati con queueParameterChange e una posizione esplicita
+    if (juce::Thread::getCurrentThreadId() == audioThreadID.load())
+        return 0;
+
+    // Da altri thread (interfaccia, automazione asincrona) il tempo trascorso dall'inizio dell'ultimo blocco
+    // viene riportato sul prossimo blocco: i cambi di un gesto mantengono la loro spaziatura nel tempo, al
+    // prezzo di una latenza di un blocco (il cambio suona un blocco dopo il momento in cui è stato fatto)
+    const double elapsedSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - lastBlockStartTicks.load());
+    return juce::jlimit(0, juce::jmax(0, lastBlockSize.load() - 1), static_cast<int>(elapsedSeconds * getSampleRate()));
+}
+
+bool AudioPluginAudioProcessor::getStageTimings(StageStats *stats, juce::int64 *droppedBlocks)
+{
+#if MULTIDELAY_STAGE_PROFILING
+    stageProfiler.get_stats(stats);                                                         // Svuota la coda del thread audio negli istogrammi
+    if (droppedBlocks != nullptr)
+        *droppedBlocks = stageProfiler.get_dropped();
+    return true;
+#else
+    juce::ignoreUnused(stats, droppedBlocks);
+    return false;
+#endif
+}
+
+void AudioPluginAudioProcessor::resetStageTimings()
+{
+#if MULTIDELAY_STAGE_PROFILING
+    stageProfiler.reset();
+#endif
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::applyParameter(Delay<SampleType> &delayToUse, MultiChannelDelay<SampleType> &multiChannelDelayToUse, Pan<SampleType> &panToUse, int parameter, float newValue)
+{
+    appliedValues[parameter] = newValue;
+
+    if (useMultiChannelDelay)
+    {
+        // Il delay multicanale ricava ritardi e matrici da più parametri: viene riconfigurato a ogni loro cambio
+        switch (parameter)
+        {
+        case delaySxParameter:
+        case delayDxParameter:
+        case syncEnableParameter:
+        case delayModeParameter:
+        case pingpongModeParameter:
+        case feedbackParameter:
+        case dryWetParameter:
+        case lowCutParameter:
+        case highCutParameter:
+            configureMultiChannelDelay(multiChannelDelayToUse);
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (parameter == panParameter)
+        panToUse.set_pan(newValue);
+    else if (parameter == rateParameter)
+        lfo.set_rate(newValue);
+    else if (parameter == amountParameter)
+        lfo.set_amount(newValue);
+    else if (parameter == shapeParameter)
+        lfo.set_shape(static_cast<int>(newValue));
+    else
+        setDelayParameter(delayToUse, parameter, newValue);
+}
+
+//==============================================================================
+const juce::String AudioPluginAudioProcessor::getName() const
+{
+#ifdef PLUGIN_NAME
+    return PLUGIN_NAME;
+#else
+    return "";
+#endif
+}
+
+bool AudioPluginAudioProcessor::acceptsMidi() const
+{
+#if JucePlugin_WantsMidiInput
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool AudioPluginAudioProcessor::producesMidi() const
+{
+#if JucePlugin_ProducesMidiOutput
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool AudioPluginAudioProcessor::isMidiEffect() const
+{
+#if JucePlugin_IsMidiEffect
+    return true;
+#else
+    return false;
+#endif
+}
+
+double AudioPluginAudioProcessor::getTailLengthSeconds() const
+{
+    if (useMultiChannelDelay)
+        return isUsingDoublePrecision() ? multiChannelDelayDouble.get_tail_length_in_seconds()
+                                        : multiChannelDelay.get_tail_length_in_seconds();
+
+    return isUsingDoublePrecision() ? delayDouble.get_tail_length_in_seconds()              // Coda del feedback del delay (infinita con feedback 1)
+                                    : delay.get_tail_length_in_seconds();
+}
+
+int AudioPluginAudioProcessor::getNumPrograms()
+{
+    return 1; // NB: some hosts don't cope very well if you tell them there are 0 programs,
+              // so this should be at least 1, even if you're not really implementing programs.
+}
+
+int AudioPluginAudioProcessor::getCurrentProgram()
+{
+    return 0;
+}
+
+void AudioPluginAudioProcessor::setCurrentProgram(int index)
+{
+    juce::ignoreUnused(index);
+}
+
+const juce::String AudioPluginAudioProcessor::getProgramName(int index)
+{
+    juce::ignoreUnused(index);
+    return {};
+}
+
+void AudioPluginAudioProcessor::changeProgramName(int index, const juce::String &newName)
+{
+    juce::ignoreUnused(index, newName);
+}
+
+//==============================================================================
+void AudioPluginAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
+{
+    // Use this method as the place to do any pre-playback
+    // initialisation that you need..
+    juce::ignoreUnused(sampleRate, samplesPerBlock);
+
+    // Il massimo ritardo (in ms) è l'estremo superiore dei parametri delay-sx/delay-dx e dei tempi dei tap
+    float maxDelayInMs = juce::jmax(parameters.getParameterRange("delay-sx").end,
+                                    parameters.getParameterRange("delay-dx").end);
+    for (int tap = 0; tap < DelayTypes::max_taps; ++tap)
+        maxDelayInMs = juce::jmax(maxDelayInMs, parameters.getParameterRange(tapParameterID(tap, "time")).end);
+    // I valori correnti vengono applicati qui sotto: gli eventi ancora in coda sono superati
+    parameterEvents.clear();
+
+    for (int parameter = 0; parameter < numParameters; ++parameter)
+        appliedValues[parameter] = parameterValues[parameter]->load();
+
+    // Viene inizializzata solo l'istanza della precisione scelta dall'host (setProcessingPrecision precede prepareToPlay)
+    if (isUsingDoublePrecision())
+        prepareDelay(delayDouble, sampleRate, samplesPerBlock, maxDelayInMs);
+    else
+        prepareDelay(delay, sampleRate, samplesPerBlock, maxDelayInMs);
+
+    // Con più di due canali (surround, ambisonico) l'effetto è applicato dal delay multicanale
+    updateChannelLayout();
+    useMultiChannelDelay = getTotalNumInputChannels() > 2;
+    if (useMultiChannelDelay)
+    {
+        if (isUsingDoublePrecision())
+        {
+            multiChannelDelayDouble.prepare(sampleRate, getTotalNumInputChannels(), maxDelayInMs);
+            configureMultiChannelDelay(multiChannelDelayDouble);
+        }
+        else
+        {
+            multiChannelDelay.prepare(sampleRate, getTotalNumInputChannels(), maxDelayInMs);
+            configureMultiChannelDelay(multiChannelDelay);
+        }
+    }
+
+    lfo.set_sample_rate(sampleRate);
+    lfo.set_rate(parameterValues[rateParameter]->load());
+    lfo.set_shape(static_cast<int>(parameterValues[shapeParameter]->load()));
+    lfo.set_amount(parameterValues[amountParameter]->load());
+
+    // Il panning viene applicato dal thread audio come gli altri parametri; la modulazione dell'LFO
+    // viene generata a blocchi (i sotto-blocchi non superano samplesPerBlock campioni)
+    pan.set_pan(parameterValues[panParameter]->load());
+    panDouble.set_pan(parameterValues[panParameter]->load());
+    pan.prepare(sampleRate);                                                                // Dopo set_pan: il panning parte già dal valore del parametro
+    panDouble.prepare(sampleRate);
+    panModulation.assign(static_cast<size_t>(juce::jmax(1, samplesPerBlock)), 0.0f);
+
+    resetStageTimings();                                                                    // Le misure precedenti valgono per un'altra configurazione
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::prepareDelay(Delay<SampleType> &delayToPrepare, double sampleRate, int samplesPerBlock, float maxDelayInMs)
+{
+    delayToPrepare.prepare(sampleRate, samplesPerBlock, maxDelayInMs);
+
+    delayToPrepare.enable_sync(static_cast<int>(*parameters.getRawParameterValue("sync-enable")));
+    delayToPrepare.set_delay_mode(static_cast<int>(*parameters.getRawParameterValue("delay-mode")));
+    delayToPrepare.set_pingpong_mode(static_cast<int>(*parameters.getRawParameterValue("pingpong-mode")));
+    delayToPrepare.set_interpolation(static_cast<int>(*parameters.getRawParameterValue("interpolation")));
+
+    delayToPrepare.set_delay_dx_in_ms(*parameters.getRawParameterValue("delay-dx"));
+    delayToPrepare.set_delay_sx_in_ms(*parameters.getRawParameterValue("delay-sx"));
+
+    delayToPrepare.set_feedback(*parameters.getRawParameterValue("feedback"));
+    delayToPrepare.set_low_cut(*parameters.getRawParameterValue("low-cut"));
+    delayToPrepare.set_high_cut(*parameters.getRawParameterValue("high-cut"));
+    delayToPrepare.set_dry_wet(*parameters.getRawParameterValue("dry-wet") / 100);
+
+    delayToPrepare.set_num_taps(static_cast<int>(*parameters.getRawParameterValue("taps")));
+    delayToPrepare.set_fdn_lines(4 << static_cast<int>(*parameters.getRawParameterValue("fdn-lines")));
+    delayToPrepare.set_fdn_matrix(static_cast<int>(*parameters.getRawParameterValue("fdn-matrix")));
+    for (int tap = 0; tap < DelayTypes::max_taps; ++tap)
+    {
+        delayToPrepare.set_tap_delay_in_ms(tap, *parameters.getRawParameterValue(tapParameterID(tap, "time")));
+        delayToPrepare.set_tap_gain(tap, *parameters.getRawParameterValue(tapParameterID(tap, "gain")));
+        delayToPrepare.set_tap_pan(tap, *parameters.getRawParameterValue(tapParameterID(tap, "pan")));
+        delayToPrepare.set_tap_feedback(tap, *parameters.getRawParameterValue(tapParameterID(tap, "feedback")));
+    }
+    reserveFdnLines(delayToPrepare);                                                        // Dopo prepare: solo se la modalità fdn è attiva
+}
+
+void AudioPluginAudioProcessor::updateChannelLayout()
+{
+    // Coppie sinistra/destra dei layout surround e immersivi di JUCE
+    using Channel = juce::AudioChannelSet::ChannelType;
+    static const std::pair<Channel, Channel> pairs[] = {
+        { juce::AudioChannelSet::left, juce::AudioChannelSet::right },
+        { juce::AudioChannelSet::leftSurround, juce::AudioChannelSet::rightSurround },
+        { juce::AudioChannelSet::leftCentre, juce::AudioChannelSet::rightCentre },
+        { juce::AudioChannelSet::leftSurroundSide, juce::AudioChannelSet::rightSurroundSide },
+        { juce::AudioChannelSet::leftSurroundRear, juce::AudioChannelSet::rightSurroundRear },
+        { juce::AudioChannelSet::topFrontLeft, juce::AudioChannelSet::topFrontRight },
+        { juce::AudioChannelSet::topRearLeft, juce::AudioChannelSet::topRearRight },
+        { juce::AudioChannelSet::wideLeft, juce::AudioChannelSet::wideRight }
+    };
+
+    const auto layout = getChannelLayoutOfBus(true, 0);
+    const int numChannels = juce::jmin(getTotalNumInputChannels(), static_cast<int>(MultiChannelDelay<float>::max_channels));
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        channelSide[channel] = 0;
+        channelPartner[channel] = channel;
+
+        const auto type = layout.getTypeOfChannel(channel);
+        for (const auto& pair : pairs)
+        {
+            if (type == pair.first || type == pair.second)
+            {
+                channelSide[channel] = (type == pair.first) ? -1 : 1;
+                const int partner = layout.getChannelIndexForType(type == pair.first ? pair.second : pair.first);
+                if (partner >= 0 && partner < numChannels)
+                    channelPartner[channel] = partner;
+            }
+        }
+    }
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::configureMultiChannelDelay(MultiChannelDelay<SampleType> &delayToConfigure)
+{
+    constexpr int maxChannels = MultiChannelDelay<SampleType>::max_channels;
+    const int numChannels = delayToConfigure.get_num_channels();
+    const bool sync = appliedValues[syncEnableParameter] >= 0.5f;
+    // Le modalità multitap e fdn sono stereo: con più canali vengono elaborate come feedback (vedi isParameterActive)
+    const bool pingpong = static_cast<int>(appliedValues[delayModeParameter]) == DelayTypes::mode_pingpong;
+    const int pingpongMode = static_cast<int>(appliedValues[pingpongModeParameter]);
+    const float feedback = appliedValues[feedbackParameter];
+
+    // Come nel delay stereo: delay-sx per i canali sinistri e centrali, delay-dx per i destri (delay-sx in sync);
+    // il feedback resta nel canale o, in pingpong, passa al canale simmetrico della coppia
+    float delaysInMs[maxChannels];
+    float routing[maxChannels * maxChannels] = {};
+    float feedbackMatrix[maxChannels * maxChannels];
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        delaysInMs[channel] = (channelSide[channel] > 0 && !sync) ? appliedValues[delayDxParameter] : appliedValues[delaySxParameter];
+        const int partner = channelPartner[channel];
+        const int feedbackSource = pingpong ? partner : channel;
+        for (int source = 0; source < numChannels; ++source)
+            feedbackMatrix[channel * numChannels + source] = (source == feedbackSource) ? feedback : 0.0f;
+
+        if (!pingpong || partner == channel)
+        {
+            routing[channel * numChannels + channel] = 1.0f;                                // Ogni linea riceve il proprio canale
+            continue;
+        }
+
+        // Pingpong di una coppia, come nel delay stereo: l'ingresso è la media dei due canali ed entra in entrambe
+        // le linee (centro) oppure solo in quella del lato scelto (sinistra, destra); i canali senza coppia
+        // (centrale, LFE, ambisonico) ricevono sempre il proprio canale
+        const bool receivesInput = pingpongMode == DelayTypes::mode_center
+                                || (pingpongMode == DelayTypes::mode_left && channelSide[channel] < 0)
+                                || (pingpongMode == DelayTypes::mode_right && channelSide[channel] > 0);
+        if (receivesInput)
+        {
+            routing[channel * numChannels + channel] = 0.5f;
+            routing[channel * numChannels + partner] = 0.5f;
+        }
+    }
+
+    delayToConfigure.set_delays_in_ms(delaysInMs);
+    delayToConfigure.set_routing_matrix(routing);
+    delayToConfigure.set_feedback_matrix(feedbackMatrix);
+    delayToConfigure.set_dry_wet(appliedValues[dryWetParameter] / 100.f);
+    delayToConfigure.set_low_cut(appliedValues[lowCutParameter]);
+    delayToConfigure.set_high_cut(appliedValues[highCutParameter]);
+}
+
+void AudioPluginAudioProcessor::releaseResources()
+{
+    // When playback stops, you can use this as an opportunity to free up any
+    // spare memory, etc.
+
+    // TODO: if needed release any attribute/dependency which has memory allocated
+    pan.reset();
+    panDouble.reset();
+    delay.reset();
+    delayDouble.reset();
+    multiChannelDelay.reset();
+    multiChannelDelayDouble.reset();
+}
+
+bool AudioPluginAudioProcessor::isBusesLayoutSupported(const BusesLayout &layouts) const
+{
+#if JucePlugin_IsMidiEffect
+    juce::ignoreUnused(layouts);
+    return true;
+#else
+    // This is the place where you check if the layout is supported.
+    // Stereo, oppure da 3 a 16 canali (surround, ambisonico) elaborati dal delay multicanale.
+    // Some plugin hosts, such as certain GarageBand versions, will only
+    // load plugins that support stereo bus layouts.
+    const int numChannels = layouts.getMainOutputChannelSet().size();
+    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo() && layouts.getMainInputChannelSet() != juce::AudioChannelSet::stereo()
+        && (numChannels < 3 || numChannels > MultiChannelDelay<float>::max_channels))
+        return false;
+
+        // This checks if the input layout matches the output layout
+#if !JucePlugin_IsSynth
+    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+        return false;
+#endif
+
+    return true;
+#endif
+}
+
+bool AudioPluginAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+void AudioPluginAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
+                                             juce::MidiBuffer &midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    processSamples(buffer, delay, multiChannelDelay, pan);
+}
+
+void AudioPluginAudioProcessor::processBlock(juce::AudioBuffer<double> &buffer,
+                                             juce::MidiBuffer &midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    processSamples(buffer, delayDouble, multiChannelDelayDouble, panDouble);
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::processSamples(juce::AudioBuffer<SampleType> &buffer, Delay<SampleType> &delayToUse, MultiChannelDelay<SampleType> &multiChannelDelayToUse, Pan<SampleType> &panToUse)
+{
+    juce::ScopedNoDenormals noDenormals;
+    MULTIDELAY_PROFILE_BLOCK(stageProfiler);                                                // Cicli del blocco e dei suoi stadi (se abilitato)
+    auto totalNumInputChannels = getTotalNumInputChannels();
+    auto totalNumOutputChannels = getTotalNumOutputChannels();
+
+    // In case we have more outputs than inputs, this code clears any output
+    // channels that didn't contain input data, (because these aren't
+    // guaranteed to be empty - they may contain garbage).
+    // This is here to avoid people getting screaming feedback
+    // when they first compile a plugin, but obviously you don't need to keep
+    // this code if your algorithm always overwrites all the output channels.
+    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+        buffer.clear(i, 0, buffer.getNumSamples());
+
+    const int numSamples = buffer.getNumSamples();
+
+    // Inizio del blocco, per stimare la posizione dei cambi di parametro che arrivano da altri thread
+    audioThreadID.store(juce::Thread::getCurrentThreadId());
+    lastBlockStartTicks.store(juce::Time::getHighResolutionTicks());
+    lastBlockSize.store(numSamples);
+
+    // Rendering offline (isNonRealtime): il thread di elaborazione può allocare e l'host può non avere un message
+    // loop (ad es. BatchRender), quindi le linee fdn dei parametri correnti vengono allocate qui, prima del blocco.
+    // Un host senza message loop che elabora in tempo reale riceve le linee solo da prepareToPlay e
+    // setStateInformation: un passaggio alla modalità fdn dopo prepareToPlay suona come feedback
+    if (isNonRealtime())
+    {
+        reserveFdnLines(delayToUse);
+        delayToUse.reserve_fdn_lines(delayToUse.get_fdn_lines_needed());
+    }
+
+    int numEvents = parameterEvents.pop_all(blockEvents, ParameterEventQueue::capacity);
+    if (parameterEvents.take_overflow())
+    {
+        // Alcuni cambi sono andati persi a coda piena: si riparte dai valori correnti di tutti i parametri
+        numEvents = 0;
+        for (int parameter = 0; parameter < numParameters; ++parameter)
+            applyParameter(delayToUse, multiChannelDelayToUse, panToUse, parameter, parameterValues[parameter]->load());
+    }
+
+    // Gli eventi oltre la fine del blocco si applicano all'ultimo campione
+    auto eventOffset = [&](int event) { return juce::jmin(blockEvents[event].sample_offset, numSamples - 1); };
+
+    // Il blocco viene diviso nei punti di cambio dei parametri: ogni sotto-blocco è elaborato con i valori
+    // in vigore dal suo primo campione, quindi le rampe dei ritardi partono dal campione del cambio
+    int event = 0;
+    for (int start = 0; start < numSamples;)
+    {
+        for (; event < numEvents && eventOffset(event) <= start; ++event)
+            applyParameter(delayToUse, multiChannelDelayToUse, panToUse, blockEvents[event].parameter, blockEvents[event].value);
+
+        // I sotto-blocchi non superano la lunghezza del buffer di modulazione (l'host può superare samplesPerBlock)
+        const int end = juce::jmin(event < numEvents ? eventOffset(event) : numSamples, start + static_cast<int>(panModulation.size()));
+        juce::AudioBuffer<SampleType> segment(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, end - start);
+
+        if (useMultiChannelDelay)                                                           // Panning e LFO valgono solo per il layout stereo (isParameterActive)
+        {
+            MULTIDELAY_PROFILE_STAGE(StageProfiler::stage_delay, multiChannelDelayToUse.process(segment));
+            start = end;
+            continue;
+        }
+
+        // Modulazione del panning: l'LFO avanza di un valore per campione, indipendentemente dal numero di canali
+        const bool modulated = lfo.get_amount() > 0.0f;
+        if (modulated)
+            MULTIDELAY_PROFILE_STAGE(StageProfiler::stage_lfo, lfo.render(panModulation.data(), segment.getNumSamples()));
+
+        MULTIDELAY_PROFILE_STAGE(StageProfiler::stage_delay, delayToUse.process(segment));  // Applica l'effetto delay al sotto-blocco
+        if (!delayToUse.is_idle())                                                          // In idle il buffer è silenzioso (sotto -120 dBFS)
+        {
+            if (modulated)
+                MULTIDELAY_PROFILE_STAGE(StageProfiler::stage_pan, panToUse.process(segment, panModulation.data()));   // Panning modulato campione per campione
+            else
+                MULTIDELAY_PROFILE_STAGE(StageProfiler::stage_pan, panToUse.process(segment));   // Panning del parametro (invariato al centro a rampa finita)
+        }
+        else
+            panToUse.skip(segment.getNumSamples());                                         // La rampa del panning prosegue anche nel silenzio
+
+        start = end;
+    }
+
+    for (; event < numEvents; ++event)                                                      // Blocco vuoto: gli eventi si applicano comunque
+        applyParameter(delayToUse, multiChannelDelayToUse, panToUse, blockEvents[event].parameter, blockEvents[event].value);
+}
+
+//==============================================================================
+bool AudioPluginAudioProcessor::hasEditor() const
+{
+    return true; // (change this to false if you choose to not supply an editor)
+}
+
+juce::AudioProcessorEditor *AudioPluginAudioProcessor::createEditor()
+{
+    return new juce::GenericAudioProcessorEditor(*this); // Use the generic editor
+}
+
+//==============================================================================
+void AudioPluginAudioProcessor::getStateInformation(juce::MemoryBlock &destData)
+{
+    // You should use this method to store your parameters in the memory block.
+    // You could do that either as raw data, or use the XML or ValueTree classes
+    // as intermediaries to make it easy to save and load complex data.
+
+    juce::MemoryOutputStream mos{destData, true};
+    parameters.state.writeToStream(mos);
+}
+
+void AudioPluginAudioProcessor::setStateInformation(const void *data, int sizeInBytes)
+{
+    // You should use this method to restore your parameters from this memory block,
+    // whose contents will have been created by the getStateInformation() call.
+    auto tree = juce::ValueTree::readFromData(data, static_cast<std::size_t>(sizeInBytes));
+    if (tree.isValid())
+    {
+        parameters.replaceState(tree);
+
+        // Un preset con la modalità fdn suona subito come fdn, anche negli host senza message loop (il timer non
+        // scatta): le linee vengono allocate qui, fuori dal thread audio
+        if (isUsingDoublePrecision())
+            reserveFdnLines(delayDouble);
+        else
+            reserveFdnLines(delay);
+    }
+}
+
+//==============================================================================
+// This creates new instances of the plugin..
+juce::AudioProcessor *JUCE_CALLTYPE createPluginFilter()
+{
+    return new AudioPluginAudioProcessor();
+}
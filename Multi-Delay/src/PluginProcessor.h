@@ -1,59 +1,152 @@
-#pragma once
-
-#include "LFO.h"     // Classe LFO
-#include "pan.h"     // Classe Pan
-#include "Delay.h"   // Classe Delay
-#include <juce_audio_processors/juce_audio_processors.h>  // Libreria JUCE
-
-//==============================================================================
-class AudioPluginAudioProcessor : public juce::AudioProcessor, public juce::AudioProcessorValueTreeState::Listener  // juce::AudioProcessorValueTreeState::Listener per gestire i cambiamenti dei parametri
-{
-public:
-    //==============================================================================
-    AudioPluginAudioProcessor();
-    ~AudioPluginAudioProcessor() override;
-
-    //==============================================================================
-    void prepareToPlay(double sampleRate, int samplesPerBlock) override;
-    void releaseResources() override;
-
-    bool isBusesLayoutSupported(const BusesLayout &layouts) const override;
-
-    using juce::AudioProcessor::processBlock;
-    void processBlock(juce::AudioBuffer<float> &, juce::MidiBuffer &) override;
-
-    //==============================================================================
-    juce::AudioProcessorEditor *createEditor() override;
-    bool hasEditor() const override;
-
-    //==============================================================================
-    const juce::String getName() const override;
-
-    bool acceptsMidi() const override;
-    bool producesMidi() const override;
-    bool isMidiEffect() const override;
-    double getTailLengthSeconds() const override;
-
-    //==============================================================================
-    int getNumPrograms() override;
-    int getCurrentProgram() override;
-    void setCurrentProgram(int index) override;
-    const juce::String getProgramName(int index) override;
-    void changeProgramName(int index, const juce::String &newName) override;
-
-    //==============================================================================
-    void getStateInformation(juce::MemoryBlock &destData) override;
-    void setStateInformation(const void *data, int sizeInBytes) override;
-
-private:
-    // We expose these parameters
-    juce::AudioProcessorValueTreeState parameters;                                               // Oggetto juce::AudioProcessorValueTreeState per gestire i parametri
-    juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();                 // Metodo per creare il layout dei parametri
-    void parameterChanged (const juce::String& parameterID, float newValue);                     // Metodo per gestire i cambiamenti dei parametri
-    LFO lfo;                                                                                     // Oggetto LFO
-    Pan pan;                                                                                     // Oggetto Pan
-    Delay delay;                                                                                 // Oggetto Delay
-
-    //==============================================================================
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioPluginAudioProcessor)
-};
+#pragma once
+
+#include "LFO.h"     // Classe LFO
+#include "pan.h"     // Classe Pan
+#include "Delay.h"   // Classe Delay
+#include "MultiChannelDelay.h"   // Classe MultiChannelDelay
+#include "ParameterEventQueue.h"   // Coda degli eventi dei parametri
+#include "StageProfiler.h"   // Misura dei cicli degli stadi di processBlock
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <juce_audio_processors/juce_audio_processors.h>  // Libreria JUCE
+
+//==============================================================================
+class AudioPluginAudioProcessor : public juce::AudioProcessor,
+                                  private juce::Timer                                                                  // juce::Timer per allocare le linee fdn fuori dal thread audio
+{
+public:
+    //==============================================================================
+    AudioPluginAudioProcessor();
+    ~AudioPluginAudioProcessor() override;
+
+    //==============================================================================
+    void prepareToPlay(double sampleRate, int samplesPerBlock) override;
+    void releaseResources() override;
+
+    bool isBusesLayoutSupported(const BusesLayout &layouts) const override;
+
+    using juce::AudioProcessor::processBlock;
+    void processBlock(juce::AudioBuffer<float> &, juce::MidiBuffer &) override;
+    void processBlock(juce::AudioBuffer<double> &, juce::MidiBuffer &) override;
+    bool supportsDoublePrecisionProcessing() const override;
+
+    //==============================================================================
+    juce::AudioProcessorEditor *createEditor() override;
+    bool hasEditor() const override;
+
+    //==============================================================================
+    const juce::String getName() const override;
+
+    bool acceptsMidi() const override;
+    bool producesMidi() const override;
+    bool isMidiEffect() const override;
+    double getTailLengthSeconds() const override;
+
+    //==============================================================================
+    int getNumPrograms() override;
+    int getCurrentProgram() override;
+    void setCurrentProgram(int index) override;
+    const juce::String getProgramName(int index) override;
+    void changeProgramName(int index, const juce::String &newName) override;
+
+    //==============================================================================
+    void getStateInformation(juce::MemoryBlock &destData) override;
+    void setStateInformation(const void *data, int sizeInBytes) override;
+
+    //==============================================================================
+    void queueParameterChange(int parameter, float newValue, int sampleOffset);                  // Accoda un cambio del parametro (ParameterIndex) per il campione sampleOffset del prossimo blocco
+    int getParameterIndex(const juce::String &parameterID) const;                                // ParameterIndex di un ID (-1 se non applicato dalla coda), non dal thread audio
+    bool isParameterActive(int parameter) const;                                                 // false se il parametro (ParameterIndex) non ha effetto con il layout corrente
+
+    // Cicli per blocco degli stadi di processBlock (StageProfiler::num_stages valori), da un thread non audio;
+    // false se il plugin è compilato senza MULTIDELAY_STAGE_PROFILING
+    bool getStageTimings(StageStats *stats, juce::int64 *droppedBlocks = nullptr);
+    void resetStageTimings();                                                                    // Azzera le misure degli stadi
+
+    enum ParameterIndex                                                                          // Parametri applicati dal thread audio tramite la coda di eventi
+    {
+        delaySxParameter,
+        delayDxParameter,
+        syncEnableParameter,
+        delayModeParameter,
+        pingpongModeParameter,
+        interpolationParameter,
+        feedbackParameter,
+        dryWetParameter,
+        tapsParameter,
+        tapTimeParameter,                                                                        // Un indice per tap: tapTimeParameter + tap
+        tapGainParameter = tapTimeParameter + DelayTypes::max_taps,
+        tapPanParameter = tapGainParameter + DelayTypes::max_taps,
+        tapFeedbackParameter = tapPanParameter + DelayTypes::max_taps,
+        fdnLinesParameter = tapFeedbackParameter + DelayTypes::max_taps,
+        fdnMatrixParameter,
+        lowCutParameter,
+        highCutParameter,
+        rateParameter,
+        amountParameter,
+        shapeParameter,
+        panParameter,
+        numParameters
+    };
+
+private:
+    // We expose these parameters
+    juce::AudioProcessorValueTreeState parameters;                                               // Oggetto juce::AudioProcessorValueTreeState per gestire i parametri
+    juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();                 // Metodo per creare il layout dei parametri
+    void parameterChanged(int parameter, float newValue);                                        // Metodo per gestire i cambiamenti dei parametri
+
+    // Un listener per parametro con il suo indice: nessuna ricerca per ID quando il parametro cambia
+    struct ParameterListener : public juce::AudioProcessorValueTreeState::Listener
+    {
+        ParameterListener(AudioPluginAudioProcessor &owner, int index);
+        void parameterChanged(const juce::String &parameterID, float newValue) override;
+        AudioPluginAudioProcessor &processor;
+        int parameter;                                                                           // ParameterIndex del parametro ascoltato
+    };
+    void timerCallback() override;                                                               // Alloca le linee fdn dei parametri e quelle attese dal thread audio
+    LFO lfo;                                                                                     // Oggetto LFO
+    Pan<float> pan;                                                                              // Oggetto Pan (elaborazione in singola precisione)
+    Pan<double> panDouble;                                                                       // Oggetto Pan (elaborazione in doppia precisione)
+    Delay<float> delay;                                                                          // Oggetto Delay (elaborazione in singola precisione)
+    Delay<double> delayDouble;                                                                   // Oggetto Delay (elaborazione in doppia precisione)
+    MultiChannelDelay<float> multiChannelDelay;                                                  // Delay per i layout con più di due canali (singola precisione)
+    MultiChannelDelay<double> multiChannelDelayDouble;                                           // Delay per i layout con più di due canali (doppia precisione)
+
+    // Layout multicanale: lato di ogni canale (-1 sinistro, +1 destro, 0 centrale o ambisonico) e canale
+    // simmetrico della coppia sinistra/destra (lo stesso canale se non ne ha uno), per ritardi e pingpong
+    std::atomic<bool> useMultiChannelDelay { false };                                            // Più di due canali in ingresso
+    int channelSide[MultiChannelDelay<float>::max_channels] = {};
+    int channelPartner[MultiChannelDelay<float>::max_channels] = {};
+    float appliedValues[numParameters] = {};                                                     // Valori applicati dal thread audio (eventi compresi)
+
+    // Automazione al campione: i cambi dei parametri vengono accodati e applicati dal thread audio
+    juce::StringArray parameterIDs;                                                              // ID dei parametri nell'ordine di ParameterIndex
+    std::vector<std::unique_ptr<ParameterListener>> parameterListeners;                          // Listener dei parametri, uno per ParameterIndex
+    std::atomic<float> *parameterValues[numParameters];                                          // Valori correnti, riletti se la coda va in overflow
+    ParameterEventQueue parameterEvents;                                                         // Cambi in attesa del prossimo blocco
+    ParameterEvent blockEvents[ParameterEventQueue::capacity];                                   // Cambi del blocco corrente, ordinati per posizione
+    std::atomic<juce::Thread::ThreadID> audioThreadID { nullptr };                               // Thread dell'ultimo processBlock
+    std::atomic<juce::int64> lastBlockStartTicks { 0 };                                          // Inizio dell'ultimo processBlock
+    std::atomic<int> lastBlockSize { 0 };                                                        // Campioni dell'ultimo processBlock
+    std::vector<float> panModulation;                                                            // Modulazione del panning generata dall'LFO, un valore per campione
+#if MULTIDELAY_STAGE_PROFILING
+    StageProfiler stageProfiler;                                                                 // Cicli di LFO, Delay, Pan e del blocco intero
+#endif
+
+    int estimateSampleOffset() const;                                                            // Posizione nel prossimo blocco di un cambio ricevuto ora
+    template <typename SampleType>
+    void applyParameter(Delay<SampleType> &delayToUse, MultiChannelDelay<SampleType> &multiChannelDelayToUse, Pan<SampleType> &panToUse, int parameter, float newValue);   // Applica un parametro (dal thread audio)
+    template <typename SampleType>
+    void prepareDelay(Delay<SampleType> &delayToPrepare, double sampleRate, int samplesPerBlock, float maxDelayInMs); // Inizializza un delay e gli applica tutti i parametri
+    template <typename SampleType>
+    void configureMultiChannelDelay(MultiChannelDelay<SampleType> &delayToConfigure);            // Ritardi, matrici e filtri del delay multicanale dai parametri applicati
+    void updateChannelLayout();                                                                  // Lati e coppie dei canali del layout corrente
+    template <typename SampleType>
+    void reserveFdnLines(Delay<SampleType> &delayToReserve);                                     // Alloca le linee fdn dei parametri correnti (mai dal thread audio in tempo reale)
+    template <typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType> &buffer, Delay<SampleType> &delayToUse, MultiChannelDelay<SampleType> &multiChannelDelayToUse, Pan<SampleType> &panToUse);   // Elaborazione comune alle due precisioni
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioPluginAudioProcessor)
+};
@@ -0,0 +1,97 @@
+// Classe SeqLock per pubblicare uno snapshot di parametri tra thread senza lock
+// Lo scrittore incrementa la sequenza (dispari = scrittura in corso), copia i dati e la riporta pari;
+// il lettore copia i dati e li accetta solo se la sequenza, pari, non è cambiata durante la copia.
+// Nessuno attende nessuno: lo scrittore non aspetta i lettori e un lettore che trova una scrittura in corso
+// (o la vede iniziare durante la copia) non riprova, tiene lo snapshot che aveva e rilegge la volta dopo.
+// Un thread audio non può quindi restare bloccato da uno scrittore interrotto a metà.
+// I dati sono memorizzati come parole atomiche (accessi relaxed), quindi la copia concorrente non è
+// una data race; T deve essere trivially copyable.
+// Gli scrittori non si sincronizzano tra loro: update deve essere chiamato da un solo thread alla volta
+// (il thread audio, oppure prepare con l'audio fermo).
+// La classe prevede un oggetto SeqLock con i seguenti parametri:
+//      - _sequence: Numero di sequenza (pari = stabile, dispari = scrittura in corso)
+//      - _words: Copia pubblicata dello snapshot
+//      - _value: Copia dello scrittore
+// Per scrivere lo snapshot (un solo thread) si utilizza il metodo:
+//      - update(modify) che applica modify(T&) allo snapshot e lo pubblica
+// Per leggere lo snapshot (da qualsiasi thread) si utilizzano i metodi:
+//      - try_read(T& value, uint32_t& version) che copia lo snapshot e la sua versione, oppure restituisce false
+//        lasciando value e version invariati se una scrittura è in corso
+//      - get_version() che restituisce la versione corrente (cambia ad ogni update)
+// La classe è un template e si trova interamente in questo header.
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef __SEQ_LOCK_HPP__
+#define __SEQ_LOCK_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+template <typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock richiede un tipo trivially copyable");
+
+private:
+    static constexpr size_t num_words = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> _sequence;                            // Pari = stabile, dispari = scrittura in corso
+    std::atomic<uint32_t> _words[num_words];                    // Snapshot pubblicato
+    T _value;                                                   // Copia dello scrittore
+
+    void publish()                                              // Copia _value nelle parole pubblicate
+    {
+        uint32_t words[num_words] = {};
+        std::memcpy(words, &_value, sizeof(T));
+        for (size_t i = 0; i < num_words; i++)
+            _words[i].store(words[i], std::memory_order_relaxed);
+    }
+
+public:
+    SeqLock() : _sequence(0), _value()
+    {
+        publish();
+    }
+
+    template <typename Function>
+    void update(Function&& modify)                              // Modifica e pubblica lo snapshot (un solo scrittore)
+    {
+        const uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+        _sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);    // La sequenza dispari precede i dati
+
+        modify(_value);
+        publish();
+
+        _sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    bool try_read(T& value, uint32_t& version) const            // Copia lo snapshot, false se una scrittura è in corso
+    {
+        const uint32_t before = _sequence.load(std::memory_order_acquire);
+        if ((before & 1u) != 0)
+            return false;                                       // Scrittura in corso
+
+        uint32_t words[num_words];
+        for (size_t i = 0; i < num_words; i++)
+            words[i] = _words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (_sequence.load(std::memory_order_relaxed) != before)
+            return false;                                       // Scrittura iniziata durante la copia
+
+        std::memcpy(&value, words, sizeof(T));
+        version = before;
+        return true;
+    }
+
+    uint32_t get_version() const                                // Versione corrente dello snapshot
+    {
+        return _sequence.load(std::memory_order_acquire);
+    }
+};
+
+#endif // __SEQ_LOCK_HPP__
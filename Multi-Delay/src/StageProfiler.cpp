@@ -0,0 +1,163 @@
+// Classe StageProfiler per misurare il costo degli stadi di processBlock (LFO, Delay, Pan e blocco intero)
+// Il thread audio legge il contatore dei cicli della CPU all'inizio e alla fine di ogni stadio e accoda,
+// una volta per blocco, i cicli di tutti gli stadi in una FIFO a capacità fissa (juce::AbstractFifo):
+// nessun lock e nessuna allocazione; a coda piena il blocco viene scartato e contato.
+// Un thread non audio (editor, benchmark, ...) svuota la coda negli istogrammi log-lineari di ogni stadio
+// (8 sotto-intervalli per ottava, errore massimo 12.5%, massimo esatto) e ne legge p50/p99/max.
+// La misura è attiva solo se compilata con MULTIDELAY_STAGE_PROFILING=1 (opzione CMake
+// MULTIDELAY_ENABLE_STAGE_PROFILING): altrimenti le macro MULTIDELAY_PROFILE_BLOCK e MULTIDELAY_PROFILE_STAGE
+// non generano codice e il processore non contiene il profiler.
+// Le unità sono cicli del contatore della CPU (TSC su x86, cntvct_el0 su arm64), oppure tick di
+// juce::Time::getHighResolutionTicks sulle altre architetture.
+// La classe prevede un oggetto StageProfiler con i seguenti parametri:
+//      - _fifo: Indici di lettura/scrittura della FIFO
+//      - _blocks: Memoria dei blocchi in attesa
+//      - _dropped: Blocchi scartati a coda piena
+//      - _read_lock: Serializza i lettori (il thread audio non lo usa)
+//      - _histograms: Istogramma dei cicli di ogni stadio
+//      - _counts: Blocchi misurati per ogni stadio
+//      - _max: Massimo esatto per ogni stadio
+// Per scrivere le misure (thread audio) si utilizzano:
+//      - push(const BlockTiming& timing) che accoda i cicli di un blocco (false se la coda è piena)
+//      - BlockRecorder e StageTimer, tramite le macro MULTIDELAY_PROFILE_BLOCK e MULTIDELAY_PROFILE_STAGE
+// Per leggere le misure (thread non audio) si utilizzano i metodi:
+//      - get_stats(StageStats* stats) che svuota la coda e restituisce p50/p99/max di ogni stadio
+//      - get_dropped() che restituisce i blocchi scartati dall'ultimo reset
+//      - reset() per azzerare istogrammi e contatori
+//      - get_stage_name(int stage) che restituisce il nome di uno stadio
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "StageProfiler.h"
+
+
+StageProfiler::StageProfiler() : _fifo(capacity), _dropped(0), _histograms(), _counts(), _max() {}
+
+bool StageProfiler::push(const BlockTiming& timing)
+{
+    const auto scope = _fifo.write(1);
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+    {
+        _dropped.fetch_add(1, std::memory_order_relaxed);       // Nessun lettore da abbastanza tempo
+        return false;
+    }
+
+    _blocks[scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2] = timing;
+    return true;
+}
+
+int StageProfiler::bucket_of(juce::uint64 cycles)
+{
+    if (cycles < sub_buckets)
+        return static_cast<int>(cycles);
+
+    // Ottava = bit più alto, sotto-intervallo = i 3 bit successivi
+    int octave = 63;
+    while ((cycles >> octave) == 0)
+        octave--;
+    const int sub = static_cast<int>((cycles >> (octave - 3)) & (sub_buckets - 1));
+    return sub_buckets + (octave - 3) * sub_buckets + sub;
+}
+
+juce::uint64 StageProfiler::bucket_upper(int bucket)
+{
+    if (bucket < sub_buckets)
+        return static_cast<juce::uint64>(bucket);
+
+    const int octave = (bucket - sub_buckets) / sub_buckets + 3;
+    const int sub = (bucket - sub_buckets) % sub_buckets;
+    const juce::uint64 width = 1ull << (octave - 3);
+    return (static_cast<juce::uint64>(sub_buckets + sub) << (octave - 3)) + (width - 1);
+}
+
+void StageProfiler::drain()
+{
+    const auto scope = _fifo.read(_fifo.getNumReady());
+
+    auto add_blocks = [this](int start, int size)
+    {
+        for (int i = start; i < start + size; i++)
+        {
+            const BlockTiming& timing = _blocks[i];
+            for (int stage = 0; stage < num_stages; stage++)
+            {
+                if ((timing.stages & (1u << stage)) == 0)
+                    continue;
+                _histograms[stage][bucket_of(timing.cycles[stage])]++;
+                _counts[stage]++;
+                _max[stage] = juce::jmax(_max[stage], timing.cycles[stage]);
+            }
+        }
+    };
+
+    add_blocks(scope.startIndex1, scope.blockSize1);
+    add_blocks(scope.startIndex2, scope.blockSize2);
+}
+
+juce::uint64 StageProfiler::percentile(int stage, double fraction) const
+{
+    if (_counts[stage] == 0)
+        return 0;
+
+    // Primo intervallo che raggiunge la frazione richiesta; il suo limite superiore non supera il massimo
+    const juce::int64 target = juce::jmax(static_cast<juce::int64>(1), static_cast<juce::int64>(fraction * static_cast<double>(_counts[stage]) + 0.5));
+    juce::int64 cumulative = 0;
+    for (int bucket = 0; bucket < num_buckets; bucket++)
+    {
+        cumulative += _histograms[stage][bucket];
+        if (cumulative >= target)
+            return juce::jmin(bucket_upper(bucket), _max[stage]);
+    }
+    return _max[stage];
+}
+
+void StageProfiler::get_stats(StageStats* stats)
+{
+    const juce::ScopedLock lock(_read_lock);
+    drain();
+
+    for (int stage = 0; stage < num_stages; stage++)
+    {
+        stats[stage].count = _counts[stage];
+        stats[stage].p50 = percentile(stage, 0.5);
+        stats[stage].p99 = percentile(stage, 0.99);
+        stats[stage].max = _max[stage];
+    }
+}
+
+juce::int64 StageProfiler::get_dropped() const
+{
+    return _dropped.load(std::memory_order_relaxed);
+}
+
+void StageProfiler::reset()
+{
+    const juce::ScopedLock lock(_read_lock);
+    _fifo.finishedRead(_fifo.getNumReady());                    // Scarta i blocchi in attesa
+
+    for (int stage = 0; stage < num_stages; stage++)
+    {
+        for (int bucket = 0; bucket < num_buckets; bucket++)
+            _histograms[stage][bucket] = 0;
+        _counts[stage] = 0;
+        _max[stage] = 0;
+    }
+    _dropped.store(0, std::memory_order_relaxed);
+}
+
+const char* StageProfiler::get_stage_name(int stage)
+{
+    switch (stage)
+    {
+    case stage_lfo:
+        return "lfo";
+    case stage_delay:
+        return "delay";
+    case stage_pan:
+        return "pan";
+    case stage_block:
+        return "block";
+    default:
+        return "";
+    }
+}
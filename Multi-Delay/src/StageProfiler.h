@@ -0,0 +1,166 @@
+// Classe StageProfiler per misurare il costo degli stadi di processBlock (LFO, Delay, Pan e blocco intero)
+// Il thread audio legge il contatore dei cicli della CPU all'inizio e alla fine di ogni stadio e accoda,
+// una volta per blocco, i cicli di tutti gli stadi in una FIFO a capacità fissa (juce::AbstractFifo):
+// nessun lock e nessuna allocazione; a coda piena il blocco viene scartato e contato.
+// Un thread non audio (editor, benchmark, ...) svuota la coda negli istogrammi log-lineari di ogni stadio
+// (8 sotto-intervalli per ottava, errore massimo 12.5%, massimo esatto) e ne legge p50/p99/max.
+// La misura è attiva solo se compilata con MULTIDELAY_STAGE_PROFILING=1 (opzione CMake
+// MULTIDELAY_ENABLE_STAGE_PROFILING): altrimenti le macro MULTIDELAY_PROFILE_BLOCK e MULTIDELAY_PROFILE_STAGE
+// non generano codice e il processore non contiene il profiler.
+// Le unità sono cicli del contatore della CPU (TSC su x86, cntvct_el0 su arm64), oppure tick di
+// juce::Time::getHighResolutionTicks sulle altre architetture.
+// La classe prevede un oggetto StageProfiler con i seguenti parametri:
+//      - _fifo: Indici di lettura/scrittura della FIFO
+//      - _blocks: Memoria dei blocchi in attesa
+//      - _dropped: Blocchi scartati a coda piena
+//      - _read_lock: Serializza i lettori (il thread audio non lo usa)
+//      - _histograms: Istogramma dei cicli di ogni stadio
+//      - _counts: Blocchi misurati per ogni stadio
+//      - _max: Massimo esatto per ogni stadio
+// Per scrivere le misure (thread audio) si utilizzano:
+//      - push(const BlockTiming& timing) che accoda i cicli di un blocco (false se la coda è piena)
+//      - BlockRecorder e StageTimer, tramite le macro MULTIDELAY_PROFILE_BLOCK e MULTIDELAY_PROFILE_STAGE
+// Per leggere le misure (thread non audio) si utilizzano i metodi:
+//      - get_stats(StageStats* stats) che svuota la coda e restituisce p50/p99/max di ogni stadio
+//      - get_dropped() che restituisce i blocchi scartati dall'ultimo reset
+//      - reset() per azzerare istogrammi e contatori
+//      - get_stage_name(int stage) che restituisce il nome di uno stadio
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef __STAGE_PROFILER_HPP__
+#define __STAGE_PROFILER_HPP__
+
+#include <juce_audio_basics/juce_audio_basics.h>                // Libreria JUCE
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#endif
+
+#ifndef MULTIDELAY_STAGE_PROFILING
+#define MULTIDELAY_STAGE_PROFILING 0
+#endif
+
+struct StageStats                                               // Cicli per blocco di uno stadio
+{
+    juce::int64 count;                                          // Blocchi misurati
+    juce::uint64 p50;
+    juce::uint64 p99;
+    juce::uint64 max;
+};
+
+class StageProfiler
+{
+public:
+    enum Stage
+    {
+        stage_lfo,                                              // LFO::render (solo con modulazione attiva)
+        stage_delay,                                            // Delay::process o MultiChannelDelay::process
+        stage_pan,                                              // Pan::process (non eseguito con il delay in idle)
+        stage_block,                                            // processBlock intero
+        num_stages
+    };
+
+    static constexpr int capacity = 1024;                       // Blocchi in attesa al massimo
+
+    struct BlockTiming                                          // Misure di un blocco
+    {
+        juce::uint64 cycles[num_stages];                        // Cicli di ogni stadio, sommati sui sotto-blocchi
+        juce::uint32 stages;                                    // Stadi eseguiti nel blocco (un bit per stadio)
+    };
+
+    static juce::uint64 read_cycles()                           // Contatore dei cicli della CPU
+    {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+        return static_cast<juce::uint64>(__rdtsc());
+#elif defined(__aarch64__)
+        juce::uint64 value;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+        return value;
+#else
+        return static_cast<juce::uint64>(juce::Time::getHighResolutionTicks());
+#endif
+    }
+
+    class BlockRecorder                                         // Misura un blocco e lo accoda alla distruzione
+    {
+    public:
+        explicit BlockRecorder(StageProfiler& profiler) : _profiler(profiler), _timing(), _start(read_cycles()) {}
+        ~BlockRecorder()
+        {
+            add(stage_block, read_cycles() - _start);
+            _profiler.push(_timing);
+        }
+
+        void add(int stage, juce::uint64 cycles)                // Somma i cicli di un sotto-blocco allo stadio
+        {
+            _timing.cycles[stage] += cycles;
+            _timing.stages |= 1u << stage;
+        }
+
+    private:
+        StageProfiler& _profiler;
+        BlockTiming _timing;
+        juce::uint64 _start;
+
+        JUCE_DECLARE_NON_COPYABLE(BlockRecorder)
+    };
+
+    class StageTimer                                            // Misura uno stadio fino alla distruzione
+    {
+    public:
+        StageTimer(BlockRecorder& recorder, int stage) : _recorder(recorder), _stage(stage), _start(read_cycles()) {}
+        ~StageTimer() { _recorder.add(_stage, read_cycles() - _start); }
+
+    private:
+        BlockRecorder& _recorder;
+        int _stage;
+        juce::uint64 _start;
+
+        JUCE_DECLARE_NON_COPYABLE(StageTimer)
+    };
+
+private:
+    static constexpr int sub_buckets = 8;                       // Sotto-intervalli per ottava
+    static constexpr int num_buckets = sub_buckets + (64 - 3) * sub_buckets;   // Valori esatti sotto 8, poi 61 ottave
+
+    juce::AbstractFifo _fifo;                                   // Indici di lettura/scrittura
+    BlockTiming _blocks[capacity];                              // Blocchi in attesa
+    std::atomic<juce::int64> _dropped;                          // Blocchi scartati a coda piena
+    juce::CriticalSection _read_lock;                           // Serializza i lettori
+    juce::int64 _histograms[num_stages][num_buckets];           // Istogramma di ogni stadio
+    juce::int64 _counts[num_stages];                            // Blocchi misurati per stadio
+    juce::uint64 _max[num_stages];                              // Massimo esatto per stadio
+
+    static int bucket_of(juce::uint64 cycles);                  // Intervallo dell'istogramma di un valore
+    static juce::uint64 bucket_upper(int bucket);               // Valore più alto di un intervallo
+    void drain();                                               // Svuota la coda negli istogrammi (con _read_lock)
+    juce::uint64 percentile(int stage, double fraction) const;  // Percentile di uno stadio (con _read_lock)
+
+public:
+    StageProfiler();                                            // Costruttore dell'oggetto StageProfiler
+
+    bool push(const BlockTiming& timing);                       // Accoda le misure di un blocco (thread audio)
+
+    void get_stats(StageStats* stats);                          // p50/p99/max di num_stages stadi (thread non audio)
+    juce::int64 get_dropped() const;                            // Blocchi scartati dall'ultimo reset
+    void reset();                                               // Azzera istogrammi e contatori (thread non audio)
+
+    static const char* get_stage_name(int stage);               // "lfo", "delay", "pan", "block"
+};
+
+// Misura del blocco corrente e dei suoi stadi: senza MULTIDELAY_STAGE_PROFILING le macro non generano codice
+// e MULTIDELAY_PROFILE_STAGE esegue solo l'istruzione
+#if MULTIDELAY_STAGE_PROFILING
+#define MULTIDELAY_PROFILE_BLOCK(profiler)  StageProfiler::BlockRecorder stageBlockRecorder(profiler)
+#define MULTIDELAY_PROFILE_STAGE(stage, ...) \
+    do { const StageProfiler::StageTimer stageTimer(stageBlockRecorder, stage); __VA_ARGS__; } while (false)
+#else
+#define MULTIDELAY_PROFILE_BLOCK(profiler)
+#define MULTIDELAY_PROFILE_STAGE(stage, ...) do { __VA_ARGS__; } while (false)
+#endif
+
+#endif // __STAGE_PROFILER_HPP__
@@ -1,42 +1,150 @@
 // Classe Pan per la gestione del panning
+// La classe è un template sul tipo dei campioni (Pan<float>, Pan<double>)
+// Il panning è applicato all'uscita stereo (segnale diretto compreso), come un bilanciamento: i guadagni sono
+// min(1, sqrt(2) * cos(theta)) e min(1, sqrt(2) * sin(theta)), con theta = (pan + 1) * pi / 4, letti da
+// una tabella del seno. Il guadagno del lato verso cui si sposta il panning è limitato a 1: al centro il
+// segnale passa invariato e agli estremi il canale attivo resta a 0 dB (nessun guadagno), mentre l'altro
+// canale scende con la legge a potenza costante. La potenza totale non è costante (-3 dB agli estremi
+// rispetto al centro): una legge con -3 dB al centro attenuerebbe anche il segnale diretto con il pan al centro.
 // La classe prevede un oggetto Pan con i seguenti parametri:
-//      - _pan: Panning (-1.0 = full left, 0.0 = center, +1.0 = full right)
+//      - _smooth_pan: Panning con smoothing (-1.0 = full left, 0.0 = center, +1.0 = full right), i cambi
+//        di set_pan sono rampe campione per campione e non gradini ai bordi dei blocchi
 // Per impostare i parametri si utilizzano i metodi:
+//      - prepare(double sample_rate) per la durata della rampa del panning (salta al valore impostato)
 //      - set_pan(float pan) per il panning
 //      - reset() per resettare il panning al centro
-// Per processare il segnale stereo si utilizza il metodo:
-//      - process(juce::AudioBuffer<float>& buffer) che prende in input il buffer stereo e applica il panning
+//      - skip(int num_samples) per avanzare la rampa del panning senza elaborare il segnale (delay in idle)
+// Per processare il segnale stereo si utilizzano i metodi:
+//      - process(juce::AudioBuffer<SampleType>& buffer) che prende in input il buffer stereo e applica il panning
+//      - process(juce::AudioBuffer<SampleType>& buffer, const float* modulation) che applica il panning _smooth_pan + modulation[i]
+//        campione per campione (modulation contiene un valore per campione del buffer, ad esempio l'LFO)
 /////////////////////////////////////////////////////////////////////////////////////////////
 
 
-#include "Pan.h"
+#include "pan.h"
 
+#define PAN_RAMP_LENGTH 0.02                                        // Durata in secondi della rampa di set_pan
+#define PAN_BLOCK_SIZE 64                                           // Campioni per sotto-blocco (i guadagni restano nello stack)
+#define PAN_TABLE_SIZE 512                                          // Segmenti della tabella su un quarto di periodo del seno
 
-Pan::Pan() : _pan{0.0f} {}                                          // Costruttore dell'oggetto Pan con inizializzazione del panning a 0
+namespace
+{
+    struct PanGainTable                                             // Tabella di min(1, sqrt(2) * sin(x * pi / 2)) per x in [0, 1]
+    {
+        struct Entry { float gain, slope; };                        // Valore e differenza con il successivo: un solo accesso per interpolazione
+        Entry entries[PAN_TABLE_SIZE + 1];                          // L'ultimo segmento ha pendenza nulla: x = 1 non esce dalla tabella
+
+        PanGainTable()
+        {
+            for (int i = 0; i <= PAN_TABLE_SIZE; ++i)
+            {
+                entries[i].gain = gain(i);
+                entries[i].slope = gain(juce::jmin(i + 1, PAN_TABLE_SIZE)) - entries[i].gain;
+            }
+        }
+
+        static float gain(int i)
+        {
+            return static_cast<float>(juce::jmin(1.0, juce::MathConstants<double>::sqrt2 * std::sin(i * juce::MathConstants<double>::halfPi / PAN_TABLE_SIZE)));
+        }
+
+        float lookup(float x) const                                 // Interpolazione lineare tra i valori della tabella
+        {
+            float position = x * PAN_TABLE_SIZE;
+            int index = static_cast<int>(position);
+            const Entry& entry = entries[index];
+            return entry.gain + (position - static_cast<float>(index)) * entry.slope;
+        }
+
+        float left_gain(float pan) const { return lookup(0.5f - 0.5f * pan); }     // cos(theta) = sin(pi/2 - theta)
+        float right_gain(float pan) const { return lookup(0.5f + 0.5f * pan); }    // sin(theta)
+    };
+
+    const PanGainTable panGainTable;                                // Calcolata una sola volta, condivisa da tutte le istanze
+}
+
+
+template <typename SampleType>
+Pan<SampleType>::Pan() {}                                           // Costruttore dell'oggetto Pan (panning al centro, senza rampa fino a prepare)
+
+template <typename SampleType>
+void Pan<SampleType>::prepare(double sample_rate)                   // Metodo per impostare la durata della rampa del panning
+{
+    _smooth_pan.reset(sample_rate, PAN_RAMP_LENGTH);                // Salta al panning impostato con set_pan
+}
+
+template <typename SampleType>
+void Pan<SampleType>::reset()                                       // Metodo per resettare il panning al centro
+{
+    _smooth_pan.set_current_and_target_value(0.0f);                 // Reset pan to center
+}
 
-void Pan::reset()                                                   // Metodo per resettare il panning al centro
+template <typename SampleType>
+void Pan<SampleType>::skip(int num_samples)                         // Metodo per avanzare la rampa senza elaborare il segnale
 {
-    _pan = 0.0f;                                                    // Reset pan to center
+    _smooth_pan.skip(num_samples);                                  // Alla ripresa il panning è dove sarebbe stato elaborando il blocco
 }
 
-void Pan::set_pan(float pan)                                        // Metodo per impostare il panning
+template <typename SampleType>
+void Pan<SampleType>::set_pan(float pan)                            // Metodo per impostare il panning
 {
-    _pan = juce::jlimit(-1.0f, 1.0f, pan);                          // Limita il panning tra -1 e 1 attraverso il metodo jlimit
+    _smooth_pan.set_target_value(juce::jlimit(-1.0f, 1.0f, pan));  // Limita il panning tra -1 e 1 e avvia la rampa verso il nuovo valore
 }
 
-void Pan::process(juce::AudioBuffer<float>& buffer)                 // Metodo per processare il segnale stereo
+template <typename SampleType>
+void Pan<SampleType>::process(juce::AudioBuffer<SampleType>& buffer) // Metodo per processare il segnale stereo
+{
+    if (_smooth_pan.is_smoothing())                                 // Rampa in corso: guadagni campione per campione
+    {
+        process_trajectory(buffer, nullptr);
+        return;
+    }
+
+    float pan = _smooth_pan.get_current_value();                    // Panning costante per tutto il blocco
+    if (pan == 0.0f)                                                // Pan al centro: il segnale passa invariato
+        return;
+
+    auto numSamples = buffer.getNumSamples();                       // Ottiene il numero di campioni
+    juce::FloatVectorOperations::multiply(buffer.getWritePointer(0), static_cast<SampleType>(panGainTable.left_gain(pan)), numSamples);
+    juce::FloatVectorOperations::multiply(buffer.getWritePointer(1), static_cast<SampleType>(panGainTable.right_gain(pan)), numSamples);
+}
+
+template <typename SampleType>
+void Pan<SampleType>::process(juce::AudioBuffer<SampleType>& buffer, const float* modulation) // Metodo per processare il segnale stereo con il panning modulato
+{
+    process_trajectory(buffer, modulation);
+}
+
+template <typename SampleType>
+void Pan<SampleType>::process_trajectory(juce::AudioBuffer<SampleType>& buffer, const float* modulation)  // Panning campione per campione
 {
     auto numSamples = buffer.getNumSamples();                       // Ottiene il numero di campioni
     auto* leftChannel = buffer.getWritePointer(0);                  // Ottiene il puntatore al canale sinistro
     auto* rightChannel = buffer.getWritePointer(1);                 // Ottiene il puntatore al canale destro
 
-                                                                    // Calcola partendo dal valore di _pan nel range [-1, 1] i guadagni dei canali sinistro e destro nel range [0, 1]
-    float leftGain = (_pan <= 0.0f) ? 1.0f : (1.0f - _pan);         // Guadagno sinistro (1 se _pan è minore o uguale a 0, altrimenti 1 - _pan)
-    float rightGain = (_pan >= 0.0f) ? 1.0f : (1.0f + _pan);        // Guadagno destro (1 se _pan è maggiore o uguale a 0, altrimenti 1 + _pan)
+    float pans[PAN_BLOCK_SIZE];                                     // Traiettoria del panning del sotto-blocco
+    SampleType leftGains[PAN_BLOCK_SIZE];                           // Guadagni del canale sinistro
+    SampleType rightGains[PAN_BLOCK_SIZE];                          // Guadagni del canale destro
 
-    for (int i = 0; i < numSamples; ++i)                            // Per ogni campione
+    for (int start = 0; start < numSamples; start += PAN_BLOCK_SIZE)
     {
-        leftChannel[i] *= leftGain;                                 // Moltiplica il campione sinistro per il guadagno sinistro
-        rightChannel[i] *= rightGain;
+        const int count = juce::jmin(PAN_BLOCK_SIZE, numSamples - start);
+
+        _smooth_pan.render(pans, count);                            // Rampa di set_pan (costante a rampa finita)
+        if (modulation != nullptr)
+            juce::FloatVectorOperations::add(pans, modulation + start, count);  // Modulazione (LFO) sommata campione per campione
+
+        for (int i = 0; i < count; ++i)                             // Guadagni dalla tabella del seno
+        {
+            float pan = juce::jlimit(-1.0f, 1.0f, pans[i]);
+            leftGains[i] = static_cast<SampleType>(panGainTable.left_gain(pan));
+            rightGains[i] = static_cast<SampleType>(panGainTable.right_gain(pan));
+        }
+
+        juce::FloatVectorOperations::multiply(leftChannel + start, leftGains, count);    // Moltiplicazione SIMD dei due canali
+        juce::FloatVectorOperations::multiply(rightChannel + start, rightGains, count);
     }
-}
\ No newline at end of file
+}
+
+template class Pan<float>;
+template class Pan<double>;
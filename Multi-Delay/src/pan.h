@@ -1,11 +1,24 @@
 // Classe Pan per la gestione del panning
+// La classe è un template sul tipo dei campioni (Pan<float>, Pan<double>)
+// Il panning è applicato all'uscita stereo (segnale diretto compreso), come un bilanciamento: i guadagni sono
+// min(1, sqrt(2) * cos(theta)) e min(1, sqrt(2) * sin(theta)), con theta = (pan + 1) * pi / 4, letti da
+// una tabella del seno. Il guadagno del lato verso cui si sposta il panning è limitato a 1: al centro il
+// segnale passa invariato e agli estremi il canale attivo resta a 0 dB (nessun guadagno), mentre l'altro
+// canale scende con la legge a potenza costante. La potenza totale non è costante (-3 dB agli estremi
+// rispetto al centro): una legge con -3 dB al centro attenuerebbe anche il segnale diretto con il pan al centro.
 // La classe prevede un oggetto Pan con i seguenti parametri:
-//      - _pan: Panning (-1.0 = full left, 0.0 = center, +1.0 = full right)
+//      - _smooth_pan: Panning con smoothing (-1.0 = full left, 0.0 = center, +1.0 = full right), i cambi
+//        di set_pan sono rampe campione per campione e non gradini ai bordi dei blocchi
 // Per impostare i parametri si utilizzano i metodi:
+//      - prepare(double sample_rate) per la durata della rampa del panning (salta al valore impostato)
 //      - set_pan(float pan) per il panning
 //      - reset() per resettare il panning al centro
-// Per processare il segnale stereo si utilizza il metodo:
-//      - process(juce::AudioBuffer<float>& buffer) che prende in input il buffer stereo e applica il panning
+//      - skip(int num_samples) per avanzare la rampa del panning senza elaborare il segnale (delay in idle)
+// Per processare il segnale stereo si utilizzano i metodi:
+//      - process(juce::AudioBuffer<SampleType>& buffer) che prende in input il buffer stereo e applica il panning
+//        (con il pan al centro il buffer passa invariato senza essere elaborato)
+//      - process(juce::AudioBuffer<SampleType>& buffer, const float* modulation) che applica il panning _smooth_pan + modulation[i]
+//        campione per campione (modulation contiene un valore per campione del buffer, ad esempio l'LFO)
 /////////////////////////////////////////////////////////////////////////////////////////////
 
 
@@ -14,18 +27,25 @@
 #define __PAN_HPP__
 
 #include <juce_audio_basics/juce_audio_basics.h>                // Libreria JUCE
+#include "BlockSmoother.h"
 
+template <typename SampleType>
 class Pan
 {
 private:
-    float _pan;                                                  // -1.0 = full left, 0.0 = center, +1.0 = full right
+    BlockSmoother _smooth_pan;                                   // -1.0 = full left, 0.0 = center, +1.0 = full right
+
+    void process_trajectory(juce::AudioBuffer<SampleType>& buffer, const float* modulation);   // Panning campione per campione
 
 public:
     Pan();                                                       // Costruttore dell'oggetto Pan
 
+    void prepare(double sample_rate);                            // Metodo per impostare la durata della rampa del panning
     void set_pan(float pan);                                     // Metodo per impostare il panning
     void reset();                                                // Metodo per resettare il panning al centro
-    void process(juce::AudioBuffer<float>& buffer);              // Metodo per processare il segnale stereo
+    void skip(int num_samples);                                  // Metodo per avanzare la rampa senza elaborare il segnale
+    void process(juce::AudioBuffer<SampleType>& buffer);         // Metodo per processare il segnale stereo
+    void process(juce::AudioBuffer<SampleType>& buffer, const float* modulation);   // Panning modulato campione per campione
 };
 
 #endif // __PAN_HPP__
\ No newline at end of file
@@ -0,0 +1,265 @@
+// Renderer offline a riga di comando
+// Legge file WAV/AIFF con juce::AudioFormatManager, li elabora con AudioPluginAudioProcessor impostato da un preset
+// e scrive il risultato, con lo stesso formato e la stessa risoluzione, nella cartella di uscita.
+// Ogni file ha la sua istanza del processore ed è un job di un juce::ThreadPool: i file vengono elaborati
+// in parallelo su tutti i core.
+// Uso:
+//      BatchRender --output <cartella> [--preset <file>] [--threads <n>] [--block-size <n>]
+//                  [--max-tail <s>] [--no-tail] <file o cartella>...
+//      - le cartelle vengono esplorate ricorsivamente (*.wav, *.aif, *.aiff) e la loro struttura è ricreata nell'uscita
+//      - il preset è l'XML dello stato dei parametri (elementi PARAM con attributi id e value), oppure il blocco
+//        binario salvato da getStateInformation
+//      - alla fine di ogni file viene elaborata la coda del delay (getTailLengthSeconds, al massimo --max-tail secondi)
+//      - i file mono vengono elaborati e scritti in stereo, i file con più di 16 canali vengono saltati
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "PluginProcessor.h"
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#define DEFAULT_BLOCK_SIZE 512
+#define DEFAULT_MAX_TAIL 10.                                                    // Secondi di coda al massimo (la coda è infinita con feedback 1)
+#define AUDIO_FILE_PATTERN "*.wav;*.aif;*.aiff"
+
+struct Preset                                                                   // Preset letto una volta e applicato a ogni processore
+{
+    std::unique_ptr<juce::XmlElement> xml;                                      // Stato in XML
+    juce::MemoryBlock state;                                                    // Oppure stato binario di getStateInformation
+
+    void apply(juce::AudioProcessor& processor) const
+    {
+        if (xml != nullptr)
+        {
+            for (auto* param : xml->getChildWithTagNameIterator("PARAM"))
+            {
+                const juce::String id = param->getStringAttribute("id");
+                for (auto* parameter : processor.getParameters())
+                    if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+                        if (ranged->paramID == id)
+                            ranged->setValueNotifyingHost(ranged->convertTo0to1(static_cast<float>(param->getDoubleAttribute("value"))));
+            }
+        }
+        else if (state.getSize() > 0)
+            processor.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+    }
+};
+
+struct RenderSettings
+{
+    juce::File output_directory;
+    int block_size = DEFAULT_BLOCK_SIZE;
+    double max_tail = DEFAULT_MAX_TAIL;
+    bool render_tail = true;
+    const Preset* preset = nullptr;
+};
+
+class RenderJob : public juce::ThreadPoolJob                                    // Elabora un file su un thread del pool
+{
+public:
+    RenderJob(const juce::File& input, const juce::String& relative_path, const RenderSettings& settings)
+        : juce::ThreadPoolJob("BatchRender"), _input(input), _relative_path(relative_path), _settings(settings) {}
+
+    JobStatus runJob() override
+    {
+        _error = render();
+        std::printf("%s %s\n", _error.isEmpty() ? "[ok]  " : "[fail]", _relative_path.toRawUTF8());
+        if (_error.isNotEmpty())
+            std::printf("       %s\n", _error.toRawUTF8());
+        return jobHasFinished;
+    }
+
+    bool failed() const { return _error.isNotEmpty(); }
+    double get_seconds() const { return _seconds; }                             // Secondi di audio scritti
+
+private:
+    juce::File _input;
+    juce::String _relative_path;                                                // Percorso del file di uscita relativo a output_directory
+    const RenderSettings& _settings;
+    juce::String _error;
+    double _seconds = 0.;
+
+    juce::String render()                                                       // Stringa vuota se il file è stato scritto
+    {
+        juce::AudioFormatManager format_manager;                                // Uno per job: nessuno stato condiviso tra i thread
+        format_manager.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(format_manager.createReaderFor(_input));
+        if (reader == nullptr)
+            return "unsupported or unreadable audio file";
+
+        const double sample_rate = reader->sampleRate;
+        const int num_channels = juce::jmax(2, static_cast<int>(reader->numChannels));   // I file mono diventano stereo
+        if (num_channels > MultiChannelDelay<float>::max_channels)
+            return "too many channels (" + juce::String(num_channels) + ")";
+
+        // Processore come lo vedrebbe un host in rendering offline
+        auto processor = std::make_unique<AudioPluginAudioProcessor>();
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(num_channels));
+        layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(num_channels));
+        if (!processor->setBusesLayout(layout))
+            return "channel layout not supported by the processor";
+        if (_settings.preset != nullptr)
+            _settings.preset->apply(*processor);
+        processor->setNonRealtime(true);
+        processor->setRateAndBufferSizeDetails(sample_rate, _settings.block_size);
+        processor->prepareToPlay(sample_rate, _settings.block_size);             // Applica i valori correnti dei parametri
+
+        const juce::File output = _settings.output_directory.getChildFile(_relative_path);
+        if (!output.getParentDirectory().createDirectory())
+            return "cannot create " + output.getParentDirectory().getFullPathName();
+        output.deleteFile();
+
+        auto* format = format_manager.findFormatForFileExtension(output.getFileExtension());
+        std::unique_ptr<juce::OutputStream> stream(output.createOutputStream());
+        if (format == nullptr || stream == nullptr)
+            return "cannot open " + output.getFullPathName();
+        const int bits_per_sample = static_cast<int>(reader->bitsPerSample);
+        std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), sample_rate, static_cast<unsigned int>(num_channels),
+                                                                                bits_per_sample, reader->metadataValues, 0));
+        if (writer == nullptr)
+            return "cannot write " + juce::String(num_channels) + " channels at " + juce::String(bits_per_sample) + " bits";
+        stream.release();                                                       // Lo stream ora appartiene al writer
+
+        double tail_seconds = _settings.render_tail ? processor->getTailLengthSeconds() : 0.;
+        if (!std::isfinite(tail_seconds) || tail_seconds > _settings.max_tail)
+            tail_seconds = _settings.max_tail;
+        const juce::int64 input_length = reader->lengthInSamples;
+        const juce::int64 total_length = input_length + static_cast<juce::int64>(std::ceil(tail_seconds * sample_rate));
+
+        juce::AudioBuffer<float> buffer(num_channels, _settings.block_size);
+        juce::MidiBuffer midi;
+        for (juce::int64 position = 0; position < total_length; position += _settings.block_size)
+        {
+            const int num_samples = static_cast<int>(juce::jmin(static_cast<juce::int64>(_settings.block_size), total_length - position));
+            const int num_read = static_cast<int>(juce::jlimit(static_cast<juce::int64>(0), static_cast<juce::int64>(num_samples), input_length - position));
+
+            buffer.setSize(num_channels, num_samples, false, false, true);
+            buffer.clear();
+            if (num_read > 0 && !reader->read(&buffer, 0, num_read, position, true, true))
+                return "read error at sample " + juce::String(position);
+
+            processor->processBlock(buffer, midi);
+
+            if (!writer->writeFromAudioSampleBuffer(buffer, 0, num_samples))
+                return "write error at sample " + juce::String(position);
+        }
+        processor->releaseResources();
+
+        _seconds = static_cast<double>(total_length) / sample_rate;
+        return {};
+    }
+};
+
+static void print_usage(const char* name)
+{
+    std::printf("usage: %s --output <dir> [--preset <file>] [--threads <n>] [--block-size <n>] [--max-tail <s>] [--no-tail] <file or dir>...\n", name);
+}
+
+static bool load_preset(const juce::File& file, Preset& preset)
+{
+    if (!file.existsAsFile())
+        return false;
+    preset.xml = juce::parseXML(file);
+    if (preset.xml == nullptr)
+        return file.loadFileAsData(preset.state);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juce_initialiser;                           // Message manager per AudioProcessorValueTreeState
+
+    const juce::File cwd = juce::File::getCurrentWorkingDirectory();
+    RenderSettings settings;
+    Preset preset;
+    int num_threads = juce::SystemStats::getNumCpus();
+    juce::Array<juce::File> inputs;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const juce::String arg(argv[i]);
+        const bool has_value = i + 1 < argc;
+        if (arg == "--output" && has_value)
+            settings.output_directory = cwd.getChildFile(argv[++i]);
+        else if (arg == "--preset" && has_value)
+        {
+            const juce::File preset_file = cwd.getChildFile(argv[++i]);
+            if (!load_preset(preset_file, preset))
+            {
+                std::printf("cannot read preset %s\n", preset_file.getFullPathName().toRawUTF8());
+                return 1;
+            }
+            settings.preset = &preset;
+        }
+        else if (arg == "--threads" && has_value)
+            num_threads = juce::jmax(1, juce::String(argv[++i]).getIntValue());
+        else if (arg == "--block-size" && has_value)
+            settings.block_size = juce::jmax(1, juce::String(argv[++i]).getIntValue());
+        else if (arg == "--max-tail" && has_value)
+            settings.max_tail = juce::jmax(0., juce::String(argv[++i]).getDoubleValue());
+        else if (arg == "--no-tail")
+            settings.render_tail = false;
+        else if (arg.startsWith("--"))
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+        else
+            inputs.add(cwd.getChildFile(arg));
+    }
+
+    if (settings.output_directory == juce::File() || inputs.isEmpty())
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Un job per file; le cartelle sono esplorate e il percorso relativo viene mantenuto nell'uscita
+    std::vector<std::unique_ptr<RenderJob>> jobs;
+    int num_missing = 0;
+    for (const auto& input : inputs)
+    {
+        if (input.isDirectory())
+        {
+            for (const auto& file : input.findChildFiles(juce::File::findFiles, true, AUDIO_FILE_PATTERN))
+                jobs.push_back(std::make_unique<RenderJob>(file, file.getRelativePathFrom(input), settings));
+        }
+        else if (input.existsAsFile())
+            jobs.push_back(std::make_unique<RenderJob>(input, input.getFileName(), settings));
+        else
+        {
+            std::printf("[skip] %s: not found\n", input.getFullPathName().toRawUTF8());
+            num_missing++;
+        }
+    }
+
+    num_threads = juce::jmin(num_threads, juce::jmax(1, static_cast<int>(jobs.size())));
+    std::printf("Rendering %d files on %d threads\n", static_cast<int>(jobs.size()), num_threads);
+
+    const juce::int64 start_ticks = juce::Time::getHighResolutionTicks();
+    {
+        juce::ThreadPool pool(num_threads);
+        for (auto& job : jobs)
+            pool.addJob(job.get(), false);                                      // I job restano di proprietà di jobs
+        for (auto& job : jobs)
+            pool.waitForJobToFinish(job.get(), -1);
+    }
+    const double elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start_ticks);
+
+    int num_failed = num_missing;
+    double seconds = 0.;
+    for (const auto& job : jobs)
+    {
+        num_failed += job->failed() ? 1 : 0;
+        seconds += job->get_seconds();
+    }
+    std::printf("%d rendered, %d failed, %.1f s of audio in %.1f s (%.1fx real time)\n",
+                static_cast<int>(jobs.size()) + num_missing - num_failed, num_failed, seconds, elapsed, elapsed > 0. ? seconds / elapsed : 0.);
+
+    return num_failed == 0 ? 0 : 1;
+}
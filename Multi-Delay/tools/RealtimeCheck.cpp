@@ -0,0 +1,496 @@
+// Controllo della sicurezza real-time di AudioPluginAudioProcessor
+// L'eseguibile ridefinisce malloc/calloc/realloc/free (e le varianti allineate), operator new/delete, i lock
+// dei pthread (mutex, rwlock, condition variable) e le attese fuori dai pthread: sched_yield (il ripiego di
+// juce::SpinLock quando è conteso), nanosleep/clock_nanosleep/usleep (juce::Thread::sleep) e le attese sui
+// futex fatte con syscall (std::atomic::wait, semafori di libstdc++). Le definizioni dell'eseguibile hanno la
+// precedenza su quelle della libc anche per JUCE e libstdc++, come con uno shim in LD_PRELOAD. Le chiamate
+// inoltrano alla libc e, se avvengono sul thread audio dentro la regione controllata, vengono contate come violazioni.
+// Non sono visibili i cicli di attesa in spazio utente che non chiamano la libc: un juce::SpinLock acquisito
+// senza contesa (una sola CAS) o un ciclo che rilegge un atomico senza cedere il thread. Il plugin non ne
+// contiene (SeqLock::try_read non riprova, ParameterEventQueue è senza lock), ma questo controllo non lo dimostra.
+// La regione controllata comprende:
+//      - processBlock, in singola e doppia precisione, stereo, 5.1, 7.1, 7.1.4 (12 canali) e ambisonico
+//        del terzo ordine (16 canali)
+//      - l'automazione dal thread audio: queueParameterChange (automazione al campione) e setValueNotifyingHost,
+//        che chiama parameterChanged in modo sincrono; per setValueNotifyingHost si controllano solo le allocazioni,
+//        perché il lock dei listener di juce::AudioProcessorParameter appartiene all'host e non al plugin
+// Intanto un secondo thread (come l'interfaccia o l'automazione dell'host) cambia i parametri fuori dalla regione.
+// Per ogni configurazione si provano tutte le modalità del delay/pingpong, le interpolazioni e le forme dell'LFO,
+// cambiando a caso un gruppo di parametri ad ogni blocco (seed fisso).
+// Esce con 1 se c'è almeno una violazione e stampa lo stack delle prime; esce con 77 (test saltato) fuori da Linux/glibc.
+// Opzioni:
+//      --blocks <n>       blocchi per configurazione (default 2000)
+//      --block-size <n>   campioni per blocco (default 256)
+//      --channels <n>     controlla solo il layout con n canali
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "PluginProcessor.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__) && defined(__GLIBC__)
+#define REALTIME_CHECK_SUPPORTED 1
+#include <cstdarg>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <linux/futex.h>
+#include <malloc.h>
+#include <new>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#define SAMPLE_RATE 48000.
+#define MAX_REPORTED_VIOLATIONS 8                                               // Violazioni di cui viene salvato lo stack
+#define MAX_STACK_DEPTH 32
+#define CHANGES_PER_BLOCK 4                                                     // Parametri cambiati dal thread audio ad ogni blocco
+
+#if defined(REALTIME_CHECK_SUPPORTED)
+
+//==============================================================================
+// Registro delle violazioni: usato dentro malloc e pthread_mutex_lock, quindi non alloca e non prende lock
+
+namespace realtime_check
+{
+    thread_local bool checking = false;                                         // Thread audio dentro la regione controllata
+    thread_local bool checking_locks = true;                                    // Anche i lock, oltre alle allocazioni
+    thread_local bool in_hook = false;                                          // Evita la ricorsione (backtrace può allocare)
+
+    struct Violation
+    {
+        const char* function;
+        void* stack[MAX_STACK_DEPTH];
+        int depth;
+    };
+
+    std::atomic<int> num_allocations { 0 };
+    std::atomic<int> num_locks { 0 };
+    Violation violations[MAX_REPORTED_VIOLATIONS];
+    std::atomic<int> num_violations { 0 };
+
+    inline void report(const char* function, bool is_lock)
+    {
+        if (!checking || in_hook || (is_lock && !checking_locks))
+            return;
+        in_hook = true;
+        (is_lock ? num_locks : num_allocations).fetch_add(1);
+        const int index = num_violations.fetch_add(1);
+        if (index < MAX_REPORTED_VIOLATIONS)
+        {
+            violations[index].function = function;
+            violations[index].depth = backtrace(violations[index].stack, MAX_STACK_DEPTH);
+        }
+        in_hook = false;
+    }
+
+    struct Scope                                                                // Regione controllata del thread corrente
+    {
+        explicit Scope(bool locks = true) { checking_locks = locks; checking = true; }
+        ~Scope() { checking = false; checking_locks = true; }
+    };
+
+    template <typename Function>
+    Function next(const char* name)                                             // Definizione successiva del simbolo (quella della libc)
+    {
+        return reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+    }
+}
+
+//==============================================================================
+// Allocazioni: inoltrate agli entry point interni della glibc, che non passano da queste definizioni
+
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* pointer, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void* pointer);
+
+    void* malloc(size_t size) noexcept
+    {
+        realtime_check::report("malloc", false);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) noexcept
+    {
+        realtime_check::report("calloc", false);
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* pointer, size_t size) noexcept
+    {
+        realtime_check::report("realloc", false);
+        return __libc_realloc(pointer, size);
+    }
+
+    void* memalign(size_t alignment, size_t size) noexcept
+    {
+        realtime_check::report("memalign", false);
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) noexcept
+    {
+        realtime_check::report("aligned_alloc", false);
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** pointer, size_t alignment, size_t size) noexcept
+    {
+        realtime_check::report("posix_memalign", false);
+        *pointer = __libc_memalign(alignment, size);
+        return *pointer != nullptr ? 0 : ENOMEM;
+    }
+
+    void free(void* pointer) noexcept
+    {
+        if (pointer != nullptr)
+            realtime_check::report("free", false);
+        __libc_free(pointer);
+    }
+}
+
+static void* checked_new(size_t size, const char* function)
+{
+    realtime_check::report(function, false);
+    if (void* pointer = __libc_malloc(size != 0 ? size : 1))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+static void* checked_new_aligned(size_t size, std::align_val_t alignment, const char* function)
+{
+    realtime_check::report(function, false);
+    if (void* pointer = __libc_memalign(static_cast<size_t>(alignment), size != 0 ? size : 1))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+static void checked_delete(void* pointer, const char* function)
+{
+    if (pointer != nullptr)
+        realtime_check::report(function, false);
+    __libc_free(pointer);
+}
+
+void* operator new(size_t size) { return checked_new(size, "operator new"); }
+void* operator new[](size_t size) { return checked_new(size, "operator new[]"); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { realtime_check::report("operator new", false); return __libc_malloc(size != 0 ? size : 1); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { realtime_check::report("operator new[]", false); return __libc_malloc(size != 0 ? size : 1); }
+void* operator new(size_t size, std::align_val_t alignment) { return checked_new_aligned(size, alignment, "operator new"); }
+void* operator new[](size_t size, std::align_val_t alignment) { return checked_new_aligned(size, alignment, "operator new[]"); }
+void operator delete(void* pointer) noexcept { checked_delete(pointer, "operator delete"); }
+void operator delete[](void* pointer) noexcept { checked_delete(pointer, "operator delete[]"); }
+void operator delete(void* pointer, size_t) noexcept { checked_delete(pointer, "operator delete"); }
+void operator delete[](void* pointer, size_t) noexcept { checked_delete(pointer, "operator delete[]"); }
+void operator delete(void* pointer, std::align_val_t) noexcept { checked_delete(pointer, "operator delete"); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { checked_delete(pointer, "operator delete[]"); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { checked_delete(pointer, "operator delete"); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { checked_delete(pointer, "operator delete[]"); }
+
+//==============================================================================
+// Lock: inoltrati alla definizione della libc trovata con dlsym(RTLD_NEXT)
+
+extern "C"
+{
+    int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+    {
+        static auto next = realtime_check::next<int (*)(pthread_mutex_t*)>("pthread_mutex_lock");
+        realtime_check::report("pthread_mutex_lock", true);
+        return next(mutex);
+    }
+
+    int pthread_mutex_trylock(pthread_mutex_t* mutex) noexcept
+    {
+        static auto next = realtime_check::next<int (*)(pthread_mutex_t*)>("pthread_mutex_trylock");
+        realtime_check::report("pthread_mutex_trylock", true);
+        return next(mutex);
+    }
+
+    int pthread_rwlock_rdlock(pthread_rwlock_t* lock) noexcept
+    {
+        static auto next = realtime_check::next<int (*)(pthread_rwlock_t*)>("pthread_rwlock_rdlock");
+        realtime_check::report("pthread_rwlock_rdlock", true);
+        return next(lock);
+    }
+
+    int pthread_rwlock_wrlock(pthread_rwlock_t* lock) noexcept
+    {
+        static auto next = realtime_check::next<int (*)(pthread_rwlock_t*)>("pthread_rwlock_wrlock");
+        realtime_check::report("pthread_rwlock_wrlock", true);
+        return next(lock);
+    }
+
+    int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex)
+    {
+        static auto next = realtime_check::next<int (*)(pthread_cond_t*, pthread_mutex_t*)>("pthread_cond_wait");
+        realtime_check::report("pthread_cond_wait", true);
+        return next(condition, mutex);
+    }
+
+    int pthread_cond_timedwait(pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* time)
+    {
+        static auto next = realtime_check::next<int (*)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*)>("pthread_cond_timedwait");
+        realtime_check::report("pthread_cond_timedwait", true);
+        return next(condition, mutex, time);
+    }
+}
+
+//==============================================================================
+// Attese fuori dai pthread: cessione del thread, sleep e futex
+
+extern "C"
+{
+    int sched_yield() noexcept
+    {
+        static auto next = realtime_check::next<int (*)()>("sched_yield");
+        realtime_check::report("sched_yield", true);
+        return next();
+    }
+
+    int nanosleep(const struct timespec* time, struct timespec* remaining)
+    {
+        static auto next = realtime_check::next<int (*)(const struct timespec*, struct timespec*)>("nanosleep");
+        realtime_check::report("nanosleep", true);
+        return next(time, remaining);
+    }
+
+    int clock_nanosleep(clockid_t clock, int flags, const struct timespec* time, struct timespec* remaining)
+    {
+        static auto next = realtime_check::next<int (*)(clockid_t, int, const struct timespec*, struct timespec*)>("clock_nanosleep");
+        realtime_check::report("clock_nanosleep", true);
+        return next(clock, flags, time, remaining);
+    }
+
+    int usleep(useconds_t microseconds)
+    {
+        static auto next = realtime_check::next<int (*)(useconds_t)>("usleep");
+        realtime_check::report("usleep", true);
+        return next(microseconds);
+    }
+
+    long syscall(long number, ...) noexcept
+    {
+        static auto next = realtime_check::next<long (*)(long, ...)>("syscall");
+
+        // Come la syscall della glibc: sei argomenti interi, quelli non passati non vengono usati dal kernel
+        long arguments[6];
+        va_list list;
+        va_start(list, number);
+        for (auto& argument : arguments)
+            argument = va_arg(list, long);
+        va_end(list);
+
+        const long operation = arguments[1] & FUTEX_CMD_MASK;
+        if (number == SYS_futex && (operation == FUTEX_WAIT || operation == FUTEX_WAIT_BITSET))
+            realtime_check::report("futex wait", true);
+        return next(number, arguments[0], arguments[1], arguments[2], arguments[3], arguments[4], arguments[5]);
+    }
+}
+
+//==============================================================================
+
+struct Mode                                                                     // Valori di delay-mode, pingpong-mode, interpolation e shape
+{
+    const char* label;
+    float delay_mode;
+    float pingpong_mode;
+};
+
+static const Mode modes[] = {
+    { "feedback", 0.f, 0.f },
+    { "pingpong center", 1.f, 0.f },
+    { "pingpong left", 1.f, 1.f },
+    { "pingpong right", 1.f, 2.f },
+    { "multitap", 2.f, 0.f },
+    { "fdn", 3.f, 0.f },
+};
+
+static juce::RangedAudioParameter* find_parameter(juce::AudioProcessor& processor, const juce::String& id)
+{
+    for (auto* parameter : processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            if (ranged->paramID == id)
+                return ranged;
+    return nullptr;
+}
+
+static void set_parameter(juce::AudioProcessor& processor, const juce::String& id, float value)
+{
+    if (auto* parameter = find_parameter(processor, id))
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+template <typename SampleType>
+static void run(int num_channels, const Mode& mode, int num_blocks, int block_size, std::mt19937& rng)
+{
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(num_channels));
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(num_channels));
+    if (!processor->setBusesLayout(layout))
+    {
+        std::printf("  %d channels not supported\n", num_channels);
+        return;
+    }
+    set_parameter(*processor, "delay-mode", mode.delay_mode);
+    set_parameter(*processor, "pingpong-mode", mode.pingpong_mode);
+    set_parameter(*processor, "amount", 0.5f);
+    processor->setProcessingPrecision(std::is_same<SampleType, double>::value ? juce::AudioProcessor::doublePrecision
+                                                                               : juce::AudioProcessor::singlePrecision);
+    processor->setRateAndBufferSizeDetails(SAMPLE_RATE, block_size);
+    processor->prepareToPlay(SAMPLE_RATE, block_size);
+
+    // Tutto quello che serve al thread audio è preparato qui, fuori dalla regione controllata
+    std::vector<juce::RangedAudioParameter*> automated;
+    std::vector<int> automated_indices;                                         // ParameterIndex, calcolati fuori dal thread audio
+    for (auto* parameter : processor->getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            if (ranged->paramID != "delay-mode" && ranged->paramID != "pingpong-mode")    // La modalità resta quella della configurazione
+            {
+                automated.push_back(ranged);
+                automated_indices.push_back(processor->getParameterIndex(ranged->paramID));
+            }
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    std::uniform_int_distribution<size_t> pick(0, automated.size() - 1);
+    std::uniform_int_distribution<int> offset(0, block_size - 1);
+
+    juce::AudioBuffer<SampleType> buffer(num_channels, block_size);
+    juce::MidiBuffer midi;
+
+    // Un secondo thread cambia i parametri come farebbe l'interfaccia
+    std::atomic<bool> running { true };
+    std::thread automation([&]
+    {
+        std::mt19937 automation_rng(4321);
+        std::uniform_real_distribution<float> automation_unit(0.f, 1.f);
+        std::uniform_int_distribution<size_t> automation_pick(0, automated.size() - 1);
+        while (running.load())
+        {
+            automated[automation_pick(automation_rng)]->setValueNotifyingHost(automation_unit(automation_rng));
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+
+    for (int block = 0; block < num_blocks; block++)
+    {
+        for (int ch = 0; ch < num_channels; ch++)
+            for (int i = 0; i < block_size; i++)
+                buffer.getWritePointer(ch)[i] = static_cast<SampleType>(unit(rng) - 0.5f);
+
+        const size_t host_parameter = pick(rng);
+        const float host_value = unit(rng);
+        size_t queued_parameters[CHANGES_PER_BLOCK];
+        float queued_values[CHANGES_PER_BLOCK];
+        int queued_offsets[CHANGES_PER_BLOCK];
+        for (int change = 0; change < CHANGES_PER_BLOCK; change++)
+        {
+            queued_parameters[change] = pick(rng);
+            queued_values[change] = automated[queued_parameters[change]]->convertFrom0to1(unit(rng));
+            queued_offsets[change] = offset(rng);
+        }
+
+        {
+            realtime_check::Scope scope(false);                                 // Automazione dell'host: solo le allocazioni
+            automated[host_parameter]->setValueNotifyingHost(host_value);
+        }
+        {
+            realtime_check::Scope scope;
+            for (int change = 0; change < CHANGES_PER_BLOCK; change++)
+                processor->queueParameterChange(automated_indices[queued_parameters[change]], queued_values[change], queued_offsets[change]);
+            processor->processBlock(buffer, midi);
+        }
+    }
+
+    running.store(false);
+    automation.join();
+    processor->releaseResources();
+}
+
+static void print_violations()
+{
+    const int count = juce::jmin(realtime_check::num_violations.load(), MAX_REPORTED_VIOLATIONS);
+    for (int v = 0; v < count; v++)
+    {
+        std::printf("\n%s on the audio thread:\n", realtime_check::violations[v].function);
+        std::fflush(stdout);
+        backtrace_symbols_fd(realtime_check::violations[v].stack, realtime_check::violations[v].depth, STDOUT_FILENO);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juce_initialiser;                           // Message manager per AudioProcessorValueTreeState
+
+    int num_blocks = 2000;
+    int block_size = 256;
+    int only_channels = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--blocks") == 0 && has_value)
+            num_blocks = juce::jmax(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--block-size") == 0 && has_value)
+            block_size = juce::jmax(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--channels") == 0 && has_value)
+            only_channels = std::atoi(argv[++i]);
+        else
+        {
+            std::printf("usage: %s [--blocks n] [--block-size n] [--channels n]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    void* warmup[1];
+    backtrace(warmup, 1);                                                       // Carica ora l'unwinder, non dentro gli hook
+
+    std::vector<int> layouts = { 2, 6, 8, 12, 16 };                             // Stereo, 5.1, 7.1, 7.1.4, ambisonico del terzo ordine
+    if (only_channels != 0)
+        layouts = { only_channels };
+
+    std::mt19937 rng(1234);
+    int failed_configurations = 0;
+    for (int num_channels : layouts)
+        for (bool double_precision : { false, true })
+            for (const auto& mode : modes)
+            {
+                const int before = realtime_check::num_violations.load();
+                if (double_precision)
+                    run<double>(num_channels, mode, num_blocks, block_size, rng);
+                else
+                    run<float>(num_channels, mode, num_blocks, block_size, rng);
+                const int found = realtime_check::num_violations.load() - before;
+                failed_configurations += found > 0 ? 1 : 0;
+                std::printf("[%s] %d channels, %s, %s\n", found == 0 ? "ok" : "FAIL", num_channels,
+                            double_precision ? "double" : "float", mode.label);
+            }
+
+    std::printf("\n%d allocations, %d locks or waits on the audio thread\n", realtime_check::num_allocations.load(), realtime_check::num_locks.load());
+    std::printf("(pthread locks, sched_yield, sleeps and futex waits; spin loops that never call libc are not detected)\n");
+    print_violations();
+    return failed_configurations == 0 ? 0 : 1;
+}
+
+#else
+
+int main()
+{
+    std::printf("RealtimeCheck needs Linux and glibc, skipped\n");
+    return 77;
+}
+
+#endif // REALTIME_CHECK_SUPPORTED